@@ -0,0 +1,9 @@
+#pragma once
+
+typedef unsigned long long __u64;
+
+// 页缓存访问计数，每个 CPU 一份，只增不减，由用户态求和后做差
+struct page_cache_stat {
+  __u64 lookups; // 读路径在页缓存中找到的 folio 数
+  __u64 misses;  // 读路径上新插入页缓存的 folio 数
+};
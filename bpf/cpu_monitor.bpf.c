@@ -0,0 +1,205 @@
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "cpu_monitor_shm.h"
+
+// 没有加载 cpu_monitor_kmod 时的替代数据源：bpf_timer 周期性读取
+// kernel_cpustat、kstat.softirqs 与 avenrun，按 cpu_monitor_shm.h 的布局
+// 写入可 mmap 的数组，用户态 CpuKmod 的读取路径与设备完全相同
+
+#define CLOCK_MONOTONIC 1
+
+// 布局由用户态按模块的规则计算后在加载前写入；verifier 把冻结的 .rodata
+// 当作常量，据此确认所有行都落在 region 之内
+const volatile __u32 nr_cpus = 1;
+const volatile __u64 header_size = 0;
+const volatile __u64 area_size = 0;
+const volatile __u64 load_off = 0;
+const volatile __u64 stat_off = 0;
+const volatile __u64 softirq_off = 0;
+
+// 刷新周期，用户态通过 skeleton 的 .data 映射在运行时修改，下一次触发生效
+__u64 interval_ns = 1000000000ULL;
+
+extern struct kernel_cpustat kernel_cpustat __ksym;
+extern struct kernel_stat kstat __ksym;
+extern const void avenrun __ksym;
+extern const void __cpu_online_mask __ksym;
+
+// 唯一一项即整个共享区域，value_size 由用户态在加载前设置
+struct {
+  __uint(type, BPF_MAP_TYPE_ARRAY);
+  __uint(map_flags, BPF_F_MMAPABLE);
+  __uint(max_entries, 1);
+  __uint(key_size, sizeof(__u32));
+  __uint(value_size, sizeof(struct cpu_monitor_header));
+} region SEC(".maps");
+
+// 与模块的 g_softirq_acc 相同：把 32 位的 softirqs 计数扩展为 64 位，
+// 以 CPU 编号为 key，max_entries 由用户态设置为 nr_cpus
+struct softirq_acc {
+  __u32 last[NR_SOFTIRQS];
+  __u64 total[NR_SOFTIRQS];
+};
+
+struct {
+  __uint(type, BPF_MAP_TYPE_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, __u32);
+  __type(value, struct softirq_acc);
+} softirq_acc SEC(".maps");
+
+struct timer_elem {
+  struct bpf_timer timer;
+};
+
+struct {
+  __uint(type, BPF_MAP_TYPE_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, __u32);
+  __type(value, struct timer_elem);
+} timers SEC(".maps");
+
+// 每次发布后写入新的 seq，代替设备的 poll 通知
+struct {
+  __uint(type, BPF_MAP_TYPE_RINGBUF);
+  __uint(max_entries, 4096);
+} events SEC(".maps");
+
+struct publish_ctx {
+  __u32 next;
+  __u64 now;
+};
+
+static bool cpu_online(__u32 cpu) {
+  unsigned long bits = 0;
+  const unsigned long *mask = (const unsigned long *)&__cpu_online_mask;
+
+  bpf_probe_read_kernel(&bits, sizeof(bits), mask + cpu / 64);
+  return bits & (1UL << (cpu % 64));
+}
+
+static __u64 softirq_count(struct softirq_acc *acc, struct kernel_stat *ks,
+                           int nr) {
+  __u32 cur = ks->softirqs[nr];
+
+  acc->total[nr] += (__u32)(cur - acc->last[nr]);
+  acc->last[nr] = cur;
+  return acc->total[nr];
+}
+
+static int update_cpu(__u32 cpu, struct publish_ctx *ctx) {
+  __u32 zero = 0;
+  char *base, *area;
+  struct cpu_monitor_stat *s;
+  struct cpu_monitor_softirq *q;
+  struct kernel_cpustat *kcs;
+  struct kernel_stat *ks;
+  struct softirq_acc *acc;
+
+  if (cpu >= nr_cpus)
+    return 1;
+  base = bpf_map_lookup_elem(&region, &zero);
+  if (!base)
+    return 1;
+  area = base + header_size + (ctx->next & 1) * area_size;
+  s = (void *)(area + stat_off + cpu * sizeof(*s));
+  q = (void *)(area + softirq_off + cpu * sizeof(*q));
+
+  kcs = bpf_per_cpu_ptr(&kernel_cpustat, cpu);
+  ks = bpf_per_cpu_ptr(&kstat, cpu);
+  acc = bpf_map_lookup_elem(&softirq_acc, &cpu);
+  if (!cpu_online(cpu) || !kcs || !ks || !acc) {
+    s->cpu_name[0] = '\0';
+    q->cpu_name[0] = '\0';
+    return 0;
+  }
+
+  s->user = kcs->cpustat[CPUTIME_USER];
+  s->nice = kcs->cpustat[CPUTIME_NICE];
+  s->system = kcs->cpustat[CPUTIME_SYSTEM];
+  s->idle = kcs->cpustat[CPUTIME_IDLE];
+  s->io_wait = kcs->cpustat[CPUTIME_IOWAIT];
+  s->irq = kcs->cpustat[CPUTIME_IRQ];
+  s->soft_irq = kcs->cpustat[CPUTIME_SOFTIRQ];
+  s->steal = kcs->cpustat[CPUTIME_STEAL];
+  s->guest = kcs->cpustat[CPUTIME_GUEST];
+  s->guest_nice = kcs->cpustat[CPUTIME_GUEST_NICE];
+  s->total = s->user + s->nice + s->system + s->idle + s->io_wait + s->irq +
+             s->soft_irq + s->steal + s->guest + s->guest_nice;
+  s->timestamp = ctx->now;
+  BPF_SNPRINTF(s->cpu_name, sizeof(s->cpu_name), "CPU%u", cpu);
+
+  q->hi = softirq_count(acc, ks, HI_SOFTIRQ);
+  q->timer = softirq_count(acc, ks, TIMER_SOFTIRQ);
+  q->net_tx = softirq_count(acc, ks, NET_TX_SOFTIRQ);
+  q->net_rx = softirq_count(acc, ks, NET_RX_SOFTIRQ);
+  q->block = softirq_count(acc, ks, BLOCK_SOFTIRQ);
+  q->irq_poll = softirq_count(acc, ks, IRQ_POLL_SOFTIRQ);
+  q->tasklet = softirq_count(acc, ks, TASKLET_SOFTIRQ);
+  q->sched = softirq_count(acc, ks, SCHED_SOFTIRQ);
+  q->hrtimer = softirq_count(acc, ks, HRTIMER_SOFTIRQ);
+  q->rcu = softirq_count(acc, ks, RCU_SOFTIRQ);
+  BPF_SNPRINTF(q->cpu_name, sizeof(q->cpu_name), "cpu%u", cpu);
+  return 0;
+}
+
+// 与模块的 update_all 相同：写入非活动数据区后在 seq 为奇数期间切换
+// active。带返回值的原子操作是完整的内存屏障（需要 -mcpu=v3），
+// 代替模块中的 smp_wmb；定时器回调不会并发执行，写端不需要加锁
+static void publish(void) {
+  __u32 zero = 0;
+  struct cpu_monitor_header *hdr;
+  struct cpu_monitor_load *load;
+  struct publish_ctx ctx;
+  unsigned long av[3] = {};
+  __u32 seq;
+
+  hdr = bpf_map_lookup_elem(&region, &zero);
+  if (!hdr)
+    return;
+  ctx.next = (hdr->active & 1) ^ 1;
+  ctx.now = bpf_ktime_get_ns();
+
+  load = (void *)((char *)hdr + header_size + ctx.next * area_size + load_off);
+  bpf_probe_read_kernel(av, sizeof(av), &avenrun);
+  load->load_avg_1 = av[0];
+  load->load_avg_3 = av[1];
+  load->load_avg_15 = av[2];
+  bpf_loop(nr_cpus, update_cpu, &ctx, 0);
+
+  seq = __sync_fetch_and_add(&hdr->seq, 1);
+  hdr->active = ctx.next;
+  hdr->timestamp_ns = ctx.now;
+  hdr->tick = hdr->tick + 1;
+  hdr->interval_ns = interval_ns;
+  __sync_lock_test_and_set(&hdr->seq, seq + 2);
+
+  seq += 2;
+  bpf_ringbuf_output(&events, &seq, sizeof(seq), 0);
+}
+
+static int on_timer(void *map, __u32 *key, struct timer_elem *elem) {
+  publish();
+  bpf_timer_start(&elem->timer, interval_ns, 0);
+  return 0;
+}
+
+// 用户态加载后通过 BPF_PROG_TEST_RUN 调用一次：先发布一次快照再启动定时器。
+// 定时器随 timers 的最后一个用户引用释放而取消，agent 退出后不再运行
+SEC("syscall")
+int start_timer(void *ctx) {
+  __u32 zero = 0;
+  struct timer_elem *elem = bpf_map_lookup_elem(&timers, &zero);
+
+  if (!elem)
+    return 1;
+  if (bpf_timer_init(&elem->timer, &timers, CLOCK_MONOTONIC) ||
+      bpf_timer_set_callback(&elem->timer, on_timer))
+    return 1;
+  publish();
+  return bpf_timer_start(&elem->timer, interval_ns, 0) ? 1 : 0;
+}
+
+char _license[] SEC("license") = "GPL";
@@ -0,0 +1,53 @@
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "drop_struct.h"
+
+#define MAX_DROP_KEYS 4096
+
+// key: drop_key, value: 丢包数；每 CPU 独立计数，由用户态汇总
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_HASH);
+  __uint(max_entries, MAX_DROP_KEYS);
+  __type(key, struct drop_key);
+  __type(value, __u64);
+} drop_count SEC(".maps");
+
+SEC("tp_btf/kfree_skb")
+int BPF_PROG(on_kfree_skb, struct sk_buff *skb, void *location,
+             enum skb_drop_reason reason) {
+  // SKB_NOT_DROPPED_YET 与 SKB_CONSUMED 不是丢包；SKB_CONSUMED 的取值随
+  // 内核版本变化，按运行内核的 BTF 重定位，没有该值的内核只排除前者
+  if (bpf_core_enum_value_exists(enum skb_drop_reason, SKB_CONSUMED)) {
+    if (reason <= bpf_core_enum_value(enum skb_drop_reason, SKB_CONSUMED))
+      return 0;
+  } else if (reason == SKB_NOT_DROPPED_YET) {
+    return 0;
+  }
+
+  // 发送路径取出口设备，已经脱离设备的接收包退回到入口 ifindex
+  struct drop_key key = {};
+  struct net_device *dev = BPF_CORE_READ(skb, dev);
+  if (dev)
+    key.ifindex = BPF_CORE_READ(dev, ifindex);
+  else
+    key.ifindex = BPF_CORE_READ(skb, skb_iif);
+  key.reason = reason;
+
+  __u64 *val = bpf_map_lookup_elem(&drop_count, &key);
+  if (val) {
+    *val += 1;
+    return 0;
+  }
+  __u64 one = 1;
+  if (bpf_map_update_elem(&drop_count, &key, &one, BPF_NOEXIST) != 0) {
+    // 其他 CPU 抢先插入了该 key，本 CPU 的计数为 0
+    val = bpf_map_lookup_elem(&drop_count, &key);
+    if (val)
+      *val += 1;
+  }
+  return 0;
+}
+
+char _license[] SEC("license") = "GPL";
@@ -0,0 +1,9 @@
+#pragma once
+
+typedef unsigned int __u32;
+
+// kfree_skb 丢包计数的 key：网卡与内核 enum skb_drop_reason 的取值
+struct drop_key {
+  __u32 ifindex;
+  __u32 reason;
+};
@@ -0,0 +1,81 @@
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "cache_struct.h"
+
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, __u32);
+  __type(value, struct page_cache_stat);
+} cache_stat SEC(".maps");
+
+// 正在执行 filemap_read 的任务；写路径（write_begin 以 FGP_CREAT 创建
+// folio）与 mmap 缺页也会插入页缓存，但没有对应的查找计数，两个计数都只在
+// 读路径内统计，命中 = 查找 - 插入才有意义
+struct {
+  __uint(type, BPF_MAP_TYPE_TASK_STORAGE);
+  __uint(map_flags, BPF_F_NO_PREALLOC);
+  __type(key, int);
+  __type(value, __u32);
+} in_read SEC(".maps");
+
+static bool reading(void) {
+  __u32 *flag = bpf_task_storage_get(&in_read, bpf_get_current_task_btf(), 0,
+                                     0);
+  return flag && *flag;
+}
+
+static void set_reading(__u32 value) {
+  __u32 *flag = bpf_task_storage_get(&in_read, bpf_get_current_task_btf(), 0,
+                                     BPF_LOCAL_STORAGE_GET_F_CREATE);
+  if (flag)
+    *flag = value;
+}
+
+// read()/readv 以及经由 filemap_read 的 splice 都从这里进入页缓存
+SEC("fentry/filemap_read")
+int BPF_PROG(on_read_enter) {
+  set_reading(1);
+  return 0;
+}
+
+SEC("fexit/filemap_read")
+int BPF_PROG(on_read_exit) {
+  set_reading(0);
+  return 0;
+}
+
+// 批量查找页缓存，返回时 fbatch 中是命中的 folio
+SEC("fexit/filemap_get_read_batch")
+int BPF_PROG(on_read_batch, struct address_space *mapping, pgoff_t index,
+             pgoff_t max, struct folio_batch *fbatch) {
+  __u32 zero = 0;
+  struct page_cache_stat *stat;
+
+  if (!reading())
+    return 0;
+  stat = bpf_map_lookup_elem(&cache_stat, &zero);
+  if (!stat)
+    return 0;
+  stat->lookups += BPF_CORE_READ(fbatch, nr);
+  return 0;
+}
+
+// 读路径上未命中时的同步、异步预读与单页读取都通过这里插入新 folio
+SEC("fentry/filemap_add_folio")
+int BPF_PROG(on_add_folio, struct address_space *mapping, struct folio *folio) {
+  __u32 zero = 0;
+  struct page_cache_stat *stat;
+
+  if (!reading())
+    return 0;
+  stat = bpf_map_lookup_elem(&cache_stat, &zero);
+  if (!stat)
+    return 0;
+  stat->misses += 1;
+  return 0;
+}
+
+char _license[] SEC("license") = "GPL";
@@ -0,0 +1,66 @@
+#include "vmlinux.h"
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+#include "proc_struct.h"
+
+#define MAX_TGIDS 16384
+
+// 每个 CPU 上当前任务开始运行的时间戳与 tgid
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, __u32);
+  __type(value, struct proc_cpu_slot);
+} switch_start SEC(".maps");
+
+// key: tgid, value: proc_cpu_val；LRU 保证活跃进程数超限时淘汰最久未运行的
+struct {
+  __uint(type, BPF_MAP_TYPE_LRU_HASH);
+  __uint(max_entries, MAX_TGIDS);
+  __type(key, __u32);
+  __type(value, struct proc_cpu_val);
+} tgid_cpu SEC(".maps");
+
+SEC("tp_btf/sched_switch")
+int BPF_PROG(on_sched_switch, bool preempt, struct task_struct *prev,
+             struct task_struct *next) {
+  __u32 zero = 0;
+  __u64 now = bpf_ktime_get_ns();
+  struct proc_cpu_slot *slot = bpf_map_lookup_elem(&switch_start, &zero);
+  if (!slot)
+    return 0;
+
+  __u64 begin = slot->start;
+  slot->start = now;
+  slot->tgid = BPF_CORE_READ(next, tgid);
+  if (begin == 0 || now <= begin)
+    return 0;
+
+  // tgid 为 0 的是 idle 任务，不计入
+  __u32 tgid = BPF_CORE_READ(prev, tgid);
+  if (tgid == 0)
+    return 0;
+
+  __u64 delta = now - begin;
+  struct proc_cpu_val *val = bpf_map_lookup_elem(&tgid_cpu, &tgid);
+  if (val) {
+    __sync_fetch_and_add(&val->on_cpu_ns, delta);
+    return 0;
+  }
+
+  // 首次出现时记录线程组组长的 comm，避免线程名覆盖进程名
+  struct proc_cpu_val init = {};
+  struct task_struct *leader = BPF_CORE_READ(prev, group_leader);
+  init.on_cpu_ns = delta;
+  bpf_probe_read_kernel_str(init.comm, sizeof(init.comm), &leader->comm);
+  if (bpf_map_update_elem(&tgid_cpu, &tgid, &init, BPF_NOEXIST) != 0) {
+    // 其他 CPU 抢先插入
+    val = bpf_map_lookup_elem(&tgid_cpu, &tgid);
+    if (val)
+      __sync_fetch_and_add(&val->on_cpu_ns, delta);
+  }
+  return 0;
+}
+
+char _license[] SEC("license") = "GPL";
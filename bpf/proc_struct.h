@@ -0,0 +1,20 @@
+#pragma once
+
+typedef unsigned long long __u64;
+typedef unsigned int __u32;
+
+#define TASK_COMM_LEN 16
+
+// 每个 tgid 自上次被用户态取走以来的累计在 CPU 上运行时间
+struct proc_cpu_val {
+  __u64 on_cpu_ns;
+  char comm[TASK_COMM_LEN];
+};
+
+// 每个 CPU 上当前运行片段的开始时间与所属 tgid（idle 为 0），用户态采集时
+// 据此把尚未切出的片段计入本周期
+struct proc_cpu_slot {
+  __u64 start;
+  __u32 tgid;
+  __u32 reserved;
+};
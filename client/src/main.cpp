@@ -3,17 +3,30 @@
 #include <unistd.h>      // 添加: 使用 syscall
 
 #include <chrono> // 添加: 使用标准库的 chrono
+#include <iostream>
 #include <memory>
 #include <thread>
 #include <vector>
 
 #include "monitor/cpu_load_monitor.hpp"
 #include "monitor/cpu_softirq_monitor.hpp"
+#include "monitor/cgroup_monitor.hpp"
 #include "monitor/cpu_stat_monitor.hpp"
 #include "monitor/disk_monitor.hpp"
+#include "monitor/drop_reason_monitor.hpp"
+#include "monitor/fs_monitor.hpp"
+#include "monitor/interrupt_monitor.hpp"
 #include "monitor/mem_monitor.hpp"
 #include "monitor/monitor_inter.hpp"
 #include "monitor/net_monitor.hpp"
+#include "monitor/numa_monitor.hpp"
+#include "monitor/page_cache_monitor.hpp"
+#include "monitor/perf_counter_monitor.hpp"
+#include "monitor/pressure_monitor.hpp"
+#include "monitor/process_monitor.hpp"
+#include "monitor/proto_stats_monitor.hpp"
+#include "monitor/tcp_sock_monitor.hpp"
+#include "monitor/vmstat_monitor.hpp"
 #include "rpc/client.hpp"
 
 #include "monitor_info.grpc.pb.h"
@@ -55,14 +68,61 @@ static struct my_passwd *my_getpwuid(uid_t uid) {
   return NULL;
 }
 
-int main() {
+// 命令行选项
+struct AgentOptions {
+  yanhon::ProcessMonitor::Source process_source =
+      yanhon::ProcessMonitor::Source::kProcfs;
+  // 通过 cachestat(2) 查询驻留情况的文件，可重复指定
+  std::vector<std::string> cache_watch_files;
+};
+
+static AgentOptions parse_options(int argc, char *argv[]) {
+  static const char kCacheWatch[] = "--cache-watch=";
+  AgentOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (strncmp(arg, kCacheWatch, sizeof(kCacheWatch) - 1) == 0 &&
+        arg[sizeof(kCacheWatch) - 1] != '\0') {
+      options.cache_watch_files.emplace_back(arg + sizeof(kCacheWatch) - 1);
+    } else if (strcmp(arg, "--process-source=ebpf") == 0) {
+      options.process_source = yanhon::ProcessMonitor::Source::kEbpf;
+    } else if (strcmp(arg, "--process-source=procfs") == 0) {
+      options.process_source = yanhon::ProcessMonitor::Source::kProcfs;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n"
+                << "usage: " << argv[0] << " [--process-source=procfs|ebpf]"
+                << " [--cache-watch=<file>]..." << std::endl;
+    }
+  }
+  return options;
+}
+
+int main(int argc, char *argv[]) {
+  AgentOptions options = parse_options(argc, argv);
   std::vector<std::shared_ptr<yanhon::MonitorInter>> runners_;
-  runners_.emplace_back(new yanhon::CpuSoftIrqMonitor());
-  runners_.emplace_back(new yanhon::CpuLoadMonitor());
-  runners_.emplace_back(new yanhon::CpuStatMonitor());
+  // 三个 CPU 监控器共用 /dev/cpu_monitor 的一个映射
+  auto cpu_kmod = std::make_shared<yanhon::CpuKmod>();
+  runners_.emplace_back(new yanhon::CpuSoftIrqMonitor(cpu_kmod));
+  runners_.emplace_back(new yanhon::InterruptMonitor());
+  runners_.emplace_back(new yanhon::CpuLoadMonitor(cpu_kmod));
+  runners_.emplace_back(new yanhon::CpuStatMonitor(cpu_kmod));
+  runners_.emplace_back(new yanhon::PerfCounterMonitor());
   runners_.emplace_back(new yanhon::MemMonitor());
+  runners_.emplace_back(new yanhon::VmStatMonitor());
+  runners_.emplace_back(
+      new yanhon::PageCacheMonitor(std::move(options.cache_watch_files)));
+  runners_.emplace_back(new yanhon::NumaMonitor());
   runners_.emplace_back(new yanhon::NetMonitor());
+  runners_.emplace_back(new yanhon::DropReasonMonitor());
+  runners_.emplace_back(new yanhon::ProtoStatsMonitor());
+  runners_.emplace_back(new yanhon::TcpSockMonitor());
   runners_.emplace_back(new yanhon::DiskMonitor());
+  runners_.emplace_back(new yanhon::FsMonitor());
+  runners_.emplace_back(new yanhon::CgroupMonitor());
+  runners_.emplace_back(
+      new yanhon::ProcessMonitor(10, 50000, options.process_source));
+  auto pressure_monitor = std::make_shared<yanhon::PressureMonitor>();
+  runners_.push_back(pressure_monitor);
 
   yanhon::RpcClient rpc_client_;
   uid_t uid = my_getuid(); // 使用自定义的 my_getuid 获取 UID
@@ -80,8 +140,17 @@ int main() {
       }
 
       rpc_client_.SetMonitorInfo(monitor_info);
-      std::this_thread::sleep_for(
-          std::chrono::seconds(3)); // 修改: 使用标准库的 chrono
+      // 等待约 3 秒，期间若 PSI 触发器报告停顿则立即进行一次带外采集；
+      // 否则再对齐到内核模块的下一次刷新，使 CPU 数据在采集时刚刚发布
+      auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
+          cpu_kmod->interval());
+      if (!cpu_kmod->ok() || interval.count() <= 0 ||
+          interval >= std::chrono::seconds(3)) {
+        pressure_monitor->WaitForStall(std::chrono::seconds(3));
+      } else if (!pressure_monitor->WaitForStall(std::chrono::seconds(3) -
+                                                 interval / 2)) {
+        cpu_kmod->WaitFresh(interval);
+      }
     }
   });
 
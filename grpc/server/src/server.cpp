@@ -33,6 +33,20 @@ RpcServerImpl::SetMonitorInfo(grpc::ServerContext *context,
               << std::endl;
   }
 
+  if (request->has_interrupt_info()) {
+    const auto &irq_info = request->interrupt_info();
+    std::cout << "  Interrupt - TotalRate: " << irq_info.total_rate()
+              << ", ActiveIrqs: " << irq_info.active_irqs()
+              << ", CpuImbalance: " << irq_info.cpu_imbalance() << std::endl;
+    for (auto i = 0; i < irq_info.irqs_size(); ++i) {
+      const auto &irq = irq_info.irqs(i);
+      std::cout << "  Irq[" << irq.irq() << "] - Name: " << irq.name()
+                << ", Rate: " << irq.rate()
+                << ", Imbalance: " << irq.imbalance()
+                << ", BusiestCpu: " << irq.busiest_cpu() << std::endl;
+    }
+  }
+
   auto cpu_stat = request->cpu_stat();
   // std::cout << "  CpuStat count: " << cpu_stat.size() << std::endl;
   for (auto i = 0; i < cpu_stat.size(); ++i) {
@@ -45,7 +59,90 @@ RpcServerImpl::SetMonitorInfo(grpc::ServerContext *context,
               << ", IdlePercent: " << stat.idle_percent()
               << ", IoWaitPercent: " << stat.io_wait_percent()
               << ", IrqPercent: " << stat.irq_percent()
-              << ", SoftIrqPercent: " << stat.soft_irq_percent() << std::endl;
+              << ", SoftIrqPercent: " << stat.soft_irq_percent();
+    if (stat.tick_count() > 0) {
+      std::cout << ", TickPercentMax: " << stat.tick_percent_max()
+                << ", TickPercentMin: " << stat.tick_percent_min()
+                << ", TickCount: " << stat.tick_count();
+    }
+    if (stat.cpu_percent_max() > 0) {
+      std::cout << ", CpuPercentMax: " << stat.cpu_percent_max()
+                << ", CpuPercentMin: " << stat.cpu_percent_min();
+    }
+    std::cout << std::endl;
+  }
+
+  auto log_topo = [](const char *tag, const auto &topo_stat) {
+    for (auto i = 0; i < topo_stat.size(); ++i) {
+      const auto &stat = topo_stat.Get(i);
+      std::cout << "  " << tag << "[" << i << "] - Name: " << stat.name()
+                << ", Cpus: " << stat.cpu_count()
+                << ", CpuPercent: " << stat.cpu_percent()
+                << ", UsrPercent: " << stat.usr_percent()
+                << ", SystemPercent: " << stat.system_percent()
+                << ", IoWaitPercent: " << stat.io_wait_percent()
+                << ", MaxCpuPercent: " << stat.max_cpu_percent()
+                << ", MinCpuPercent: " << stat.min_cpu_percent() << std::endl;
+    }
+  };
+  log_topo("CpuSocketStat", request->cpu_socket_stat());
+  log_topo("CpuCoreStat", request->cpu_core_stat());
+
+  if (request->has_perf_counter_info()) {
+    const auto &perf = request->perf_counter_info();
+    auto log_perf = [](const std::string &tag, const auto &counter) {
+      std::cout << "  " << tag << " - Cycles: " << counter.cycles()
+                << ", Instructions: " << counter.instructions()
+                << ", Ipc: " << counter.ipc()
+                << ", LlcMpki: " << counter.llc_mpki()
+                << ", BranchMpki: " << counter.branch_mpki()
+                << ", CtxSwitch: " << counter.context_switches()
+                << ", Migrations: " << counter.cpu_migrations()
+                << ", PageFaults: " << counter.page_faults()
+                << ", RunningPercent: " << counter.running_percent()
+                << std::endl;
+    };
+    log_perf(perf.hardware() ? "PerfTotal" : "PerfTotal(software)",
+             perf.total());
+    for (auto i = 0; i < perf.cpus_size(); ++i) {
+      log_perf("PerfCpu[" + std::to_string(perf.cpus(i).cpu()) + "]",
+               perf.cpus(i));
+    }
+  }
+
+  if (request->has_proto_stats()) {
+    const auto &proto_stats = request->proto_stats();
+    std::cout << "  ProtoStats - TcpCurrEstab: " << proto_stats.tcp_curr_estab()
+              << ", TcpRetransSegs/s: " << proto_stats.tcp_retrans_segs()
+              << ", TcpRetransPercent: " << proto_stats.tcp_retrans_percent()
+              << ", ListenOverflows/s: " << proto_stats.listen_overflows()
+              << ", ListenDrops/s: " << proto_stats.listen_drops()
+              << ", TcpBacklogDrop/s: " << proto_stats.tcp_backlog_drop()
+              << ", TcpTimeouts/s: " << proto_stats.tcp_timeouts()
+              << ", UdpRcvbufErrors/s: " << proto_stats.udp_rcvbuf_errors()
+              << ", UdpSndbufErrors/s: " << proto_stats.udp_sndbuf_errors()
+              << ", UdpNoPorts/s: " << proto_stats.udp_no_ports() << std::endl;
+  }
+
+  if (request->has_tcp_sock_info()) {
+    const auto &tcp = request->tcp_sock_info();
+    std::cout << "  TcpSock - Total: " << tcp.total()
+              << ", Established: " << tcp.established()
+              << ", SynRecv: " << tcp.syn_recv()
+              << ", TimeWait: " << tcp.time_wait()
+              << ", CloseWait: " << tcp.close_wait()
+              << ", Listen: " << tcp.listen()
+              << ", RttP50(us): " << tcp.rtt_us_p50()
+              << ", RttP99(us): " << tcp.rtt_us_p99()
+              << ", CwndP50: " << tcp.cwnd_p50()
+              << ", Retransmitting: " << tcp.retransmitting()
+              << ", ScanCostMs: " << tcp.scan_cost_ms() << std::endl;
+    for (auto i = 0; i < tcp.listen_queues_size(); ++i) {
+      const auto &lq = tcp.listen_queues(i);
+      std::cout << "  ListenQueue[" << lq.port() << "] - Queue: " << lq.queue()
+                << ", Backlog: " << lq.backlog()
+                << ", FillPercent: " << lq.fill_percent() << std::endl;
+    }
   }
 
   auto disk_info = request->disk_info();
@@ -69,6 +166,16 @@ RpcServerImpl::SetMonitorInfo(grpc::ServerContext *context,
               << ", UtilPercent: " << disk.util_percent() << std::endl;
   }
 
+  for (const auto &fs : request->fs_info()) {
+    std::cout << "  FsInfo[" << fs.mount_point() << "] - Type: " << fs.fs_type()
+              << ", Source: " << fs.source()
+              << ", TotalBytes: " << fs.total_bytes()
+              << ", UsedPercent: " << fs.used_percent()
+              << ", InodesPercent: " << fs.inodes_percent()
+              << ", FillRate: " << fs.fill_rate()
+              << ", SecondsToFull: " << fs.seconds_to_full() << std::endl;
+  }
+
   auto mem_info = request->mem_info();
   std::cout << "  MemInfo - Total: " << mem_info.total()
             << ", Free: " << mem_info.free() << ", Avail: " << mem_info.avail()
@@ -90,6 +197,48 @@ RpcServerImpl::SetMonitorInfo(grpc::ServerContext *context,
             << ", SUnreclaim: " << mem_info.sunreclaim()
             << ", UsedPercent: " << mem_info.used_percent() << std::endl;
 
+  auto vm_stat = request->vm_stat();
+  std::cout << "  VmStat - PgFault/s: " << vm_stat.pgfault()
+            << ", PgMajFault/s: " << vm_stat.pgmajfault()
+            << ", PswpIn/s: " << vm_stat.pswpin()
+            << ", PswpOut/s: " << vm_stat.pswpout()
+            << ", PgScanKswapd/s: " << vm_stat.pgscan_kswapd()
+            << ", PgScanDirect/s: " << vm_stat.pgscan_direct()
+            << ", PgStealKswapd/s: " << vm_stat.pgsteal_kswapd()
+            << ", PgStealDirect/s: " << vm_stat.pgsteal_direct()
+            << ", AllocStall/s: " << vm_stat.allocstall()
+            << ", CompactStall/s: " << vm_stat.compact_stall()
+            << ", OomKill/s: " << vm_stat.oom_kill()
+            << ", ReclaimEfficiency: " << vm_stat.reclaim_efficiency()
+            << std::endl;
+
+  if (request->has_page_cache()) {
+    const auto &cache = request->page_cache();
+    std::cout << "  PageCache - Lookup/s: " << cache.lookup_rate()
+              << ", Miss/s: " << cache.miss_rate()
+              << ", HitRatio: " << cache.hit_ratio() << std::endl;
+    for (const auto &file : cache.files()) {
+      std::cout << "  CachedFile[" << file.path()
+                << "] - CachedPercent: " << file.cached_percent()
+                << ", DirtyPages: " << file.dirty_pages()
+                << ", RecentlyEvicted: " << file.recently_evicted()
+                << ", Evicted/s: " << file.evicted_rate() << std::endl;
+    }
+  }
+
+  auto numa_info = request->numa_info();
+  for (auto i = 0; i < numa_info.size(); ++i) {
+    const auto &node = numa_info.Get(i);
+    std::cout << "  NumaNode[" << node.node() << "] - Total: " << node.total()
+              << ", Free: " << node.free()
+              << ", UsedPercent: " << node.used_percent()
+              << ", NumaHit/s: " << node.numa_hit()
+              << ", NumaMiss/s: " << node.numa_miss()
+              << ", NumaForeign/s: " << node.numa_foreign()
+              << ", MissPercent: " << node.miss_percent()
+              << ", RemotePercent: " << node.remote_percent() << std::endl;
+  }
+
   auto net_info = request->net_info();
   for (auto i = 0; i < net_info.size(); ++i) {
     const auto &net = net_info.Get(i);
@@ -104,7 +253,76 @@ RpcServerImpl::SetMonitorInfo(grpc::ServerContext *context,
               << ", ErrInRate: " << net.err_in_rate()
               << ", ErrOutRate: " << net.err_out_rate()
               << ", DropInRate: " << net.drop_in_rate()
-              << ", DropOutRate: " << net.drop_out_rate() << std::endl;
+              << ", DropOutRate: " << net.drop_out_rate()
+              << ", Qdisc: " << net.qdisc_kind()
+              << ", QdiscBacklogBytes: " << net.qdisc_backlog_bytes()
+              << ", QdiscBacklogPackets: " << net.qdisc_backlog_packets()
+              << ", QdiscDropRate: " << net.qdisc_drop_rate()
+              << ", QdiscOverlimitRate: " << net.qdisc_overlimit_rate()
+              << ", QdiscRequeueRate: " << net.qdisc_requeue_rate()
+              << ", QdiscDelayMs: " << net.qdisc_delay_ms() << std::endl;
+  }
+
+  for (const auto &drops : request->drop_reasons()) {
+    std::cout << "  DropReasons[" << drops.name()
+              << "] - TotalRate: " << drops.total_rate();
+    for (const auto &reason : drops.reasons()) {
+      std::cout << ", " << reason.reason() << ": " << reason.rate();
+    }
+    std::cout << std::endl;
+  }
+
+  auto pressure_info = request->pressure_info();
+  for (auto i = 0; i < pressure_info.resources_size(); ++i) {
+    const auto &res = pressure_info.resources(i);
+    std::cout << "  Pressure[" << res.resource()
+              << "] - SomeAvg10: " << res.some().avg10()
+              << ", SomeAvg60: " << res.some().avg60()
+              << ", SomeStall%: " << res.some().stall_percent()
+              << ", FullAvg10: " << res.full().avg10()
+              << ", FullAvg60: " << res.full().avg60()
+              << ", FullStall%: " << res.full().stall_percent()
+              << ", Triggered: " << res.triggered() << std::endl;
+  }
+
+  auto cgroup_info = request->cgroup_info();
+  for (auto i = 0; i < cgroup_info.size(); ++i) {
+    const auto &cg = cgroup_info.Get(i);
+    std::cout << "  Cgroup[" << i << "] - Path: " << cg.path()
+              << ", CpuPercent: " << cg.cpu_percent()
+              << ", ThrottledPercent: " << cg.throttled_percent()
+              << ", MemoryCurrent: " << cg.memory_current()
+              << ", ReadBytesPerSec: " << cg.read_bytes_per_sec()
+              << ", WriteBytesPerSec: " << cg.write_bytes_per_sec()
+              << ", MemPressureSome: " << cg.memory_pressure_some()
+              << ", IoPressureSome: " << cg.io_pressure_some() << std::endl;
+  }
+
+  auto process_info = request->process_info();
+  std::cout << "  ProcessInfo - TotalPids: " << process_info.total_pids()
+            << ", ScanCostMs: " << process_info.scan_cost_ms()
+            << ", BudgetExceeded: " << process_info.budget_exceeded()
+            << std::endl;
+  for (auto i = 0; i < process_info.top_cpu_size(); ++i) {
+    const auto &proc = process_info.top_cpu(i);
+    std::cout << "  TopCpu[" << i << "] - Pid: " << proc.pid()
+              << ", Comm: " << proc.comm()
+              << ", CpuPercent: " << proc.cpu_percent()
+              << ", Rss: " << proc.rss() << std::endl;
+  }
+  for (auto i = 0; i < process_info.top_rss_size(); ++i) {
+    const auto &proc = process_info.top_rss(i);
+    std::cout << "  TopRss[" << i << "] - Pid: " << proc.pid()
+              << ", Comm: " << proc.comm() << ", Rss: " << proc.rss()
+              << ", Shared: " << proc.shared() << std::endl;
+  }
+  for (auto i = 0; i < process_info.top_io_size(); ++i) {
+    const auto &proc = process_info.top_io(i);
+    std::cout << "  TopIo[" << i << "] - Pid: " << proc.pid()
+              << ", Comm: " << proc.comm()
+              << ", ReadBytesPerSec: " << proc.read_bytes_per_sec()
+              << ", WriteBytesPerSec: " << proc.write_bytes_per_sec()
+              << std::endl;
   }
 
   return grpc::Status::OK;
@@ -0,0 +1,165 @@
+/*
+ * cpu_monitor 内核模块与用户态共用的共享内存布局
+ *
+ * /dev/cpu_monitor 映射出的区域：
+ *   struct cpu_monitor_header
+ *   数据区 0（header_size 处）
+ *   数据区 1（header_size + area_size 处）
+ *   共享分段（CPU_MONITOR_SECTION_F_SHARED：历史环与突发统计 BURST）
+ * 每个数据区内按 sections[] 的 offset 存放各分段的行。定时器写入非活动的
+ * 数据区后，在 seq 为奇数期间切换 active；读端复制 active 数据区前后
+ * seq 相同且为偶数即得到一份完整快照，一次检查覆盖所有分段
+ *
+ * 突发统计（BURST）由模块内部的高频定时器维护两组逐 CPU 行，按代轮换：
+ * 定时器只写当前代 gen & 1 那一组；消费者调用 CPU_MONITOR_IOC_BURST_NEXT
+ * 结束当前代并开始新一代（新一组行被清零），返回刚结束的代号，随后读取
+ * 该代对应的一组，直到下次调用前不会再被写入。只支持一个消费者
+ *
+ * 历史环不做双缓冲，每次发布覆盖最旧的一项：写入前把该项的 tick 清零，
+ * 写完后再填入新的 tick；读端复制前后 tick 都等于期望值即为完整的一项
+ *
+ * 刷新周期可在运行时通过 CPU_MONITOR_IOC_SET_INTERVAL 调整（需要
+ * CAP_SYS_ADMIN），取值被限制在 [INTERVAL_MIN_NS, INTERVAL_MAX_NS]，
+ * 每次发布时写入 interval_ns
+ *
+ * 没有加载模块时，bpf/cpu_monitor.bpf.c 在 BPF_F_MMAPABLE 数组中按同样的
+ * 布局发布快照（只有 LOAD/STAT/SOFTIRQ 三个分段），BPF 程序包含本文件前
+ * 已包含 vmlinux.h，此时不再包含 uapi 头文件，也不定义 ioctl 命令
+ *
+ * 只使用定长类型并显式对齐，32/64 位用户态看到的布局相同；
+ * 任何不兼容的布局变化都必须增加 CPU_MONITOR_VERSION
+ */
+#pragma once
+
+#ifndef __VMLINUX_H__
+#include <linux/ioctl.h>
+#include <linux/types.h>
+#endif
+
+#define CPU_MONITOR_DEVICE "cpu_monitor"
+#define CPU_MONITOR_MAGIC 0x4d555043 /* "CPUM" */
+#define CPU_MONITOR_VERSION 2
+#define CPU_MONITOR_MAX_SECTIONS 8
+#define CPU_MONITOR_ALIGN 64
+#define CPU_MONITOR_HISTORY_DEPTH 64
+#define CPU_MONITOR_INTERVAL_MIN_NS 10000000ULL    /* 10ms */
+#define CPU_MONITOR_INTERVAL_MAX_NS 60000000000ULL /* 60s */
+
+#ifndef __VMLINUX_H__
+/* 参数为期望的周期（纳秒），返回时改写为限制后实际生效的周期 */
+#define CPU_MONITOR_IOC_SET_INTERVAL _IOWR('C', 1, __u64)
+/* 结束当前突发统计代并返回其代号，需要 CAP_SYS_ADMIN */
+#define CPU_MONITOR_IOC_BURST_NEXT _IOR('C', 2, __u64)
+#endif
+
+enum cpu_monitor_section_id {
+  CPU_MONITOR_SECTION_LOAD = 1,
+  CPU_MONITOR_SECTION_STAT = 2,
+  CPU_MONITOR_SECTION_SOFTIRQ = 3,
+  CPU_MONITOR_SECTION_STAT_HISTORY = 4,
+  CPU_MONITOR_SECTION_BURST = 5,
+};
+
+/* 分段不在双缓冲数据区内，offset 相对映射起始处 */
+#define CPU_MONITOR_SECTION_F_SHARED 0x1
+
+struct cpu_monitor_section {
+  __u32 id; /* enum cpu_monitor_section_id，0 表示空 */
+  __u32 nr_rows;
+  __u32 row_size;
+  __u32 flags;  /* CPU_MONITOR_SECTION_F_* */
+  __u64 offset; /* 相对数据区起始处的偏移 */
+  __u64 reserved2;
+};
+
+struct cpu_monitor_header {
+  __u32 magic;
+  __u32 version;
+  __u32 header_size; /* sizeof(struct cpu_monitor_header) */
+  __u32 nr_sections;
+  __u32 seq;    /* 偶数表示稳定，切换数据区期间为奇数 */
+  __u32 active; /* 当前可读的数据区下标 */
+  __u64 area_size;
+  __u64 timestamp_ns; /* 最近一次发布的 CLOCK_MONOTONIC 时间 */
+  __u64 interval_ns;  /* 发布该快照时生效的刷新周期 */
+  __u64 tick;         /* 已发布的次数，即历史环中最新一项的 tick */
+  __u32 nr_cpus;      /* 内核的 nr_cpu_ids，逐 CPU 分段的行数 */
+  __u32 reserved;
+  struct cpu_monitor_section sections[CPU_MONITOR_MAX_SECTIONS];
+};
+
+/* avenrun[] 原始定点值，小数部分 11 位 */
+struct cpu_monitor_load {
+  __u64 load_avg_1;
+  __u64 load_avg_3;
+  __u64 load_avg_15;
+};
+
+/* kernel_cpustat 的累计值（纳秒），离线 CPU 的 cpu_name 为空 */
+struct cpu_monitor_stat {
+  char cpu_name[16];
+  __u64 user;
+  __u64 system;
+  __u64 idle;
+  __u64 nice;
+  __u64 io_wait;
+  __u64 irq;
+  __u64 soft_irq;
+  __u64 steal;
+  __u64 guest;
+  __u64 guest_nice;
+  __u64 total;
+  __u64 timestamp;
+};
+
+/* 历史环中一个 CPU 的累计时间（纳秒），离线 CPU 两者均为 0 */
+struct cpu_monitor_sample {
+  __u64 busy;  /* user + nice + system + irq + softirq + steal */
+  __u64 total; /* busy + idle + iowait */
+};
+
+/*
+ * 历史环的一项，行大小为 sizeof(本结构) + nr_cpus 个 cpu_monitor_sample，
+ * 按 CPU_MONITOR_ALIGN 对齐；tick 为 0 表示空或正在写入，
+ * 第 t 次发布写入下标 t % nr_rows 的一项
+ */
+struct cpu_monitor_history_slot {
+  __u64 tick;
+  __u64 timestamp_ns;
+  __u32 nr_cpus;
+  __u32 reserved;
+  __u64 reserved2;
+  struct cpu_monitor_sample samples[];
+};
+
+/*
+ * 一代内逐 CPU 的采样窗口使用率范围（万分比），窗口为模块参数 burst_ms
+ * （没有 NOHZ 空闲时钟时至少 10 个 tick）。
+ * BURST 分段共 2 * nr_cpus 行，第 g 代使用第 (g & 1) * nr_cpus 行开始的
+ * 一组；samples 为 0 时 max/min 无效
+ */
+struct cpu_monitor_burst {
+  __u32 max_bp;
+  __u32 min_bp;
+  __u32 samples;
+  __u32 reserved;
+};
+
+/*
+ * 软中断累计次数，离线 CPU 的 cpu_name 为空。内核的 kstat_softirqs_cpu
+ * 是 32 位计数，模块每个周期累加其增量扩展为 64 位；每行按 CPU_MONITOR_ALIGN
+ * 对齐，不与相邻 CPU 的行共享缓存行（版本 1 为 packed 的 32 位计数）
+ */
+struct cpu_monitor_softirq {
+  char cpu_name[16];
+  __u64 hi;
+  __u64 timer;
+  __u64 net_tx;
+  __u64 net_rx;
+  __u64 block;
+  __u64 irq_poll;
+  __u64 tasklet;
+  __u64 sched;
+  __u64 hrtimer;
+  __u64 rcu;
+} __attribute__((aligned(CPU_MONITOR_ALIGN)));
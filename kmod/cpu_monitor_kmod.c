@@ -0,0 +1,596 @@
+#include <linux/capability.h>
+#include <linux/cpumask.h>
+#include <linux/fs.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
+#include <linux/kernel.h>
+#include <linux/kernel_stat.h>
+#include <linux/ktime.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
+#include <linux/moduleparam.h>
+#include <linux/percpu.h>
+#include <linux/module.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/sched/loadavg.h>
+#include <linux/spinlock.h>
+#include <linux/tick.h>
+#include <linux/uaccess.h>
+#include <linux/version.h>
+#include <linux/vmalloc.h>
+#include <linux/wait.h>
+
+#include "cpu_monitor_shm.h"
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(5, 6, 0)
+#error "This module requires Linux kernel version 5.6 or later"
+#endif
+
+
+MODULE_LICENSE("GPL");
+MODULE_AUTHOR("yanhon");
+MODULE_DESCRIPTION("CPU load/stat/softirq monitor with a single mmap region");
+
+static unsigned int interval_ms = 1000;
+module_param(interval_ms, uint, 0444);
+MODULE_PARM_DESC(interval_ms, "Initial refresh interval in milliseconds");
+
+static unsigned int burst_ms = 10;
+module_param(burst_ms, uint, 0444);
+MODULE_PARM_DESC(burst_ms,
+                 "Sampling period for per-CPU busy min/max in ms, 0 disables; "
+                 "raised to 10 ticks when the NOHZ idle clock is off");
+
+// 分段在 header->sections[] 中的下标
+enum {
+  SEC_LOAD,
+  SEC_STAT,
+  SEC_SOFTIRQ,
+  SEC_HISTORY,
+  SEC_BURST,
+  NR_SECTIONS
+};
+
+static void *g_shm = NULL;
+static struct cpu_monitor_header *g_hdr = NULL;
+static unsigned long g_shm_size;
+static struct hrtimer g_timer;
+static ktime_t g_interval;
+// 串行化周期调整，定时器回调只读取 g_interval
+static DEFINE_MUTEX(g_interval_lock);
+// 每次发布新快照后唤醒 poll/read 的等待者
+static DECLARE_WAIT_QUEUE_HEAD(g_wait);
+
+// 没有 NOHZ 空闲时钟时 burst 窗口至少覆盖的 tick 数，忙碌比例的分辨率为
+// 1 / CPU_MONITOR_BURST_MIN_TICKS
+#define CPU_MONITOR_BURST_MIN_TICKS 10
+
+static struct hrtimer g_burst_timer;
+static ktime_t g_burst_interval;
+static u64 g_burst_last_ns;
+// 忙碌时间由 NOHZ 的空闲时钟计算，否则退回到按 tick 记账的 kcpustat
+static bool g_burst_idle_clock;
+// 保护当前代号与 BURST 行，由定时器回调（硬中断上下文）与 ioctl 共用
+static DEFINE_SPINLOCK(g_burst_lock);
+static u64 g_burst_gen;
+
+struct burst_prev {
+  u64 busy;
+  bool valid;
+};
+static DEFINE_PER_CPU(struct burst_prev, g_burst_prev);
+
+static void *section_rows(u32 area, int sec) {
+  return (char *)g_shm + g_hdr->header_size + area * g_hdr->area_size +
+         g_hdr->sections[sec].offset;
+}
+
+static struct cpu_monitor_history_slot *history_slot(u64 tick) {
+  const struct cpu_monitor_section *sec = &g_hdr->sections[SEC_HISTORY];
+
+  return (void *)((char *)g_shm + sec->offset +
+                  (tick % sec->nr_rows) * sec->row_size);
+}
+
+static void update_load(struct cpu_monitor_load *load) {
+  load->load_avg_1 = avenrun[0];
+  load->load_avg_3 = avenrun[1];
+  load->load_avg_15 = avenrun[2];
+}
+
+static void update_stat(struct cpu_monitor_stat *stats) {
+  int cpu;
+  struct kernel_cpustat *kcs;
+  struct cpu_monitor_stat *s;
+
+  for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
+    s = &stats[cpu];
+    if (!cpu_online(cpu)) {
+      s->cpu_name[0] = '\0';
+      continue;
+    }
+    kcs = &kcpustat_cpu(cpu);
+    s->user = kcs->cpustat[CPUTIME_USER];
+    s->nice = kcs->cpustat[CPUTIME_NICE];
+    s->system = kcs->cpustat[CPUTIME_SYSTEM];
+    s->idle = kcs->cpustat[CPUTIME_IDLE];
+    s->io_wait = kcs->cpustat[CPUTIME_IOWAIT];
+    s->irq = kcs->cpustat[CPUTIME_IRQ];
+    s->soft_irq = kcs->cpustat[CPUTIME_SOFTIRQ];
+    s->steal = kcs->cpustat[CPUTIME_STEAL];
+    // 表示虚拟化环境的CPU时间
+    s->guest = kcs->cpustat[CPUTIME_GUEST];
+    s->guest_nice = kcs->cpustat[CPUTIME_GUEST_NICE];
+    s->total = s->user + s->nice + s->system + s->idle + s->io_wait + s->irq +
+               s->soft_irq + s->steal + s->guest + s->guest_nice;
+    snprintf(s->cpu_name, sizeof(s->cpu_name), "CPU%d", cpu);
+    s->timestamp = ktime_get_ns();
+  }
+}
+
+/*
+ * kstat_softirqs_cpu 返回 32 位计数，繁忙机器上 NET_RX/TIMER 几小时就会
+ * 回绕；每个周期按 u32 取增量累加到 64 位，周期上限 60 秒内不会漏掉回绕
+ */
+struct softirq_acc {
+  u32 last[NR_SOFTIRQS];
+  u64 total[NR_SOFTIRQS];
+};
+static DEFINE_PER_CPU(struct softirq_acc, g_softirq_acc);
+
+static u64 softirq_count(struct softirq_acc *acc, unsigned int nr, int cpu) {
+  u32 cur = kstat_softirqs_cpu(nr, cpu);
+
+  acc->total[nr] += (u32)(cur - acc->last[nr]);
+  acc->last[nr] = cur;
+  return acc->total[nr];
+}
+
+static void update_softirq(struct cpu_monitor_softirq *stats) {
+  int cpu;
+  struct cpu_monitor_softirq *s;
+  struct softirq_acc *acc;
+
+  for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
+    s = &stats[cpu];
+    if (!cpu_online(cpu)) {
+      s->cpu_name[0] = '\0';
+      continue;
+    }
+    acc = per_cpu_ptr(&g_softirq_acc, cpu);
+    snprintf(s->cpu_name, sizeof(s->cpu_name), "cpu%d", cpu);
+    s->hi = softirq_count(acc, HI_SOFTIRQ, cpu);
+    s->timer = softirq_count(acc, TIMER_SOFTIRQ, cpu);
+    s->net_tx = softirq_count(acc, NET_TX_SOFTIRQ, cpu);
+    s->net_rx = softirq_count(acc, NET_RX_SOFTIRQ, cpu);
+    s->block = softirq_count(acc, BLOCK_SOFTIRQ, cpu);
+    s->irq_poll = softirq_count(acc, IRQ_POLL_SOFTIRQ, cpu);
+    s->tasklet = softirq_count(acc, TASKLET_SOFTIRQ, cpu);
+    s->sched = softirq_count(acc, SCHED_SOFTIRQ, cpu);
+    s->hrtimer = softirq_count(acc, HRTIMER_SOFTIRQ, cpu);
+    s->rcu = softirq_count(acc, RCU_SOFTIRQ, cpu);
+  }
+}
+
+/*
+ * 由刚写入的 STAT 行生成历史环中的一项，覆盖 tick - DEPTH 的旧数据；
+ * busy/total 的口径与用户态 CpuStatMonitor 一致，不含 guest 时间
+ */
+static void update_history(const struct cpu_monitor_stat *stats, u64 tick,
+                           u64 now) {
+  struct cpu_monitor_history_slot *slot = history_slot(tick);
+  const struct cpu_monitor_stat *s;
+  u64 busy;
+  int cpu;
+
+  WRITE_ONCE(slot->tick, 0);
+  smp_wmb();
+  for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
+    s = &stats[cpu];
+    if (s->cpu_name[0] == '\0') {
+      slot->samples[cpu].busy = 0;
+      slot->samples[cpu].total = 0;
+      continue;
+    }
+    busy = s->user + s->nice + s->system + s->irq + s->soft_irq + s->steal;
+    slot->samples[cpu].busy = busy;
+    slot->samples[cpu].total = busy + s->idle + s->io_wait;
+  }
+  slot->timestamp_ns = now;
+  slot->nr_cpus = nr_cpu_ids;
+  smp_wmb();
+  WRITE_ONCE(slot->tick, tick);
+}
+
+/*
+ * 写入非活动数据区后切换 active，相当于在共享内存中的
+ * raw_write_seqcount_begin/end。只在模块初始化和 hrtimer 回调中调用，
+ * 二者不会并发，写端不需要加锁
+ */
+static void update_all(void) {
+  u32 next = READ_ONCE(g_hdr->active) ^ 1;
+  u64 tick = g_hdr->tick + 1;
+  u64 now;
+
+  update_load(section_rows(next, SEC_LOAD));
+  update_stat(section_rows(next, SEC_STAT));
+  update_softirq(section_rows(next, SEC_SOFTIRQ));
+  now = ktime_get_ns();
+  update_history(section_rows(next, SEC_STAT), tick, now);
+
+  WRITE_ONCE(g_hdr->seq, g_hdr->seq + 1);
+  smp_wmb();
+  WRITE_ONCE(g_hdr->active, next);
+  WRITE_ONCE(g_hdr->timestamp_ns, now);
+  WRITE_ONCE(g_hdr->tick, tick);
+  WRITE_ONCE(g_hdr->interval_ns, ktime_to_ns(READ_ONCE(g_interval)));
+  smp_wmb();
+  WRITE_ONCE(g_hdr->seq, g_hdr->seq + 1);
+}
+
+static enum hrtimer_restart cpu_monitor_timer_callback(struct hrtimer *timer) {
+  update_all();
+  wake_up_interruptible(&g_wait);
+  hrtimer_forward_now(timer, READ_ONCE(g_interval));
+  return HRTIMER_RESTART;
+}
+
+/*
+ * 每个打开的文件在 private_data 中记录最后一次 read 到的 seq（初始为 0），
+ * 当前 seq 为偶数且与之不同即有尚未读取的新快照。seq 为奇数时发布尚未
+ * 完成，发布结束后的 wake_up 会再次唤醒等待者
+ */
+static bool snapshot_pending(struct file *filp, u32 *seq) {
+  u32 cur = READ_ONCE(g_hdr->seq);
+
+  if (seq) {
+    *seq = cur;
+  }
+  return !(cur & 1) && cur != (u32)(unsigned long)filp->private_data;
+}
+
+static int cpu_monitor_open(struct inode *inode, struct file *filp) {
+  // misc_open 会把 private_data 设为 miscdevice，这里改为保存 seq
+  filp->private_data = NULL;
+  return stream_open(inode, filp);
+}
+
+/*
+ * 读取最新快照的 seq（__u32）并标记为已读，不拷贝数据本身，数据仍通过
+ * mmap 读取。没有新快照时阻塞，O_NONBLOCK 下返回 -EAGAIN
+ */
+static ssize_t cpu_monitor_read(struct file *filp, char __user *buf,
+                                size_t count, loff_t *ppos) {
+  u32 seq;
+
+  if (count < sizeof(seq)) {
+    return -EINVAL;
+  }
+  if (!snapshot_pending(filp, &seq)) {
+    if (filp->f_flags & O_NONBLOCK) {
+      return -EAGAIN;
+    }
+    if (wait_event_interruptible(g_wait, snapshot_pending(filp, &seq))) {
+      return -ERESTARTSYS;
+    }
+  }
+  if (copy_to_user(buf, &seq, sizeof(seq))) {
+    return -EFAULT;
+  }
+  filp->private_data = (void *)(unsigned long)seq;
+  return sizeof(seq);
+}
+
+static __poll_t cpu_monitor_poll(struct file *filp, poll_table *wait) {
+  poll_wait(filp, &g_wait, wait);
+  return snapshot_pending(filp, NULL) ? EPOLLIN | EPOLLRDNORM : 0;
+}
+
+static struct cpu_monitor_burst *burst_rows(u64 gen) {
+  const struct cpu_monitor_section *sec = &g_hdr->sections[SEC_BURST];
+
+  return (struct cpu_monitor_burst *)((char *)g_shm + sec->offset) +
+         (gen & 1) * nr_cpu_ids;
+}
+
+static void burst_reset(struct cpu_monitor_burst *rows) {
+  int cpu;
+
+  for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
+    rows[cpu].max_bp = 0;
+    rows[cpu].min_bp = 10000;
+    rows[cpu].samples = 0;
+  }
+}
+
+/*
+ * CPU 的累计忙碌时间。kcpustat 在每个 tick 把整个 tick 记给当时的状态，
+ * 10ms 窗口在 HZ=100 时只能得到 0% 或 100%；NOHZ 的空闲时钟在进出空闲
+ * 时按纳秒记账，忙碌时间取墙钟时间减去空闲与 iowait
+ */
+static u64 cpu_busy_ns(int cpu, u64 now) {
+  const u64 *cpustat;
+  u64 idle_us, iowait_us;
+
+  if (g_burst_idle_clock) {
+    idle_us = get_cpu_idle_time_us(cpu, NULL);
+    iowait_us = get_cpu_iowait_time_us(cpu, NULL);
+    if (idle_us != -1ULL && iowait_us != -1ULL) {
+      return now - (idle_us + iowait_us) * NSEC_PER_USEC;
+    }
+  }
+  cpustat = kcpustat_cpu(cpu).cpustat;
+  return cpustat[CPUTIME_USER] + cpustat[CPUTIME_NICE] +
+         cpustat[CPUTIME_SYSTEM] + cpustat[CPUTIME_IRQ] +
+         cpustat[CPUTIME_SOFTIRQ] + cpustat[CPUTIME_STEAL];
+}
+
+static enum hrtimer_restart burst_timer_callback(struct hrtimer *timer) {
+  u64 now = ktime_get_ns();
+  u64 dt = now - g_burst_last_ns;
+  struct cpu_monitor_burst *rows;
+  struct burst_prev *prev;
+  u64 busy;
+  u32 bp;
+  int cpu;
+
+  spin_lock(&g_burst_lock);
+  rows = burst_rows(g_burst_gen);
+  for (cpu = 0; cpu < nr_cpu_ids; ++cpu) {
+    prev = per_cpu_ptr(&g_burst_prev, cpu);
+    if (!cpu_online(cpu)) {
+      prev->valid = false;
+      continue;
+    }
+    busy = cpu_busy_ns(cpu, now);
+    if (prev->valid && dt > 0) {
+      bp = busy > prev->busy
+               ? min_t(u64, div64_u64((busy - prev->busy) * 10000, dt), 10000)
+               : 0;
+      rows[cpu].max_bp = max(rows[cpu].max_bp, bp);
+      rows[cpu].min_bp = min(rows[cpu].min_bp, bp);
+      rows[cpu].samples++;
+    }
+    prev->busy = busy;
+    prev->valid = true;
+  }
+  spin_unlock(&g_burst_lock);
+
+  g_burst_last_ns = now;
+  hrtimer_forward_now(timer, g_burst_interval);
+  return HRTIMER_RESTART;
+}
+
+static u64 clamp_interval(u64 ns) {
+  return clamp_t(u64, ns, CPU_MONITOR_INTERVAL_MIN_NS,
+                 CPU_MONITOR_INTERVAL_MAX_NS);
+}
+
+/*
+ * 先取消定时器再以新周期重新启动，新周期立即生效；hrtimer_cancel 会等待
+ * 正在执行的回调结束，避免与回调中的 hrtimer_forward_now 竞争
+ */
+static long set_interval(u64 __user *arg) {
+  u64 ns;
+
+  if (copy_from_user(&ns, arg, sizeof(ns))) {
+    return -EFAULT;
+  }
+  ns = clamp_interval(ns);
+
+  mutex_lock(&g_interval_lock);
+  hrtimer_cancel(&g_timer);
+  WRITE_ONCE(g_interval, ns_to_ktime(ns));
+  hrtimer_start(&g_timer, g_interval, HRTIMER_MODE_REL);
+  mutex_unlock(&g_interval_lock);
+
+  printk(KERN_INFO "cpu_monitor: refresh interval set to %llu ns\n", ns);
+  return copy_to_user(arg, &ns, sizeof(ns)) ? -EFAULT : 0;
+}
+
+// 结束当前代，清零下一代的一组行后切换，返回刚结束的代号
+static long burst_next(u64 __user *arg) {
+  u64 gen;
+
+  spin_lock_irq(&g_burst_lock);
+  gen = g_burst_gen;
+  burst_reset(burst_rows(gen + 1));
+  g_burst_gen = gen + 1;
+  spin_unlock_irq(&g_burst_lock);
+  return put_user(gen, arg);
+}
+
+static long cpu_monitor_ioctl(struct file *filp, unsigned int cmd,
+                              unsigned long arg) {
+  switch (cmd) {
+  case CPU_MONITOR_IOC_SET_INTERVAL:
+  case CPU_MONITOR_IOC_BURST_NEXT:
+    break;
+  default:
+    return -ENOTTY;
+  }
+  if (!capable(CAP_SYS_ADMIN)) {
+    return -EPERM;
+  }
+  if (cmd == CPU_MONITOR_IOC_SET_INTERVAL) {
+    return set_interval((u64 __user *)arg);
+  }
+  return burst_next((u64 __user *)arg);
+}
+
+static int cpu_monitor_mmap(struct file *filp, struct vm_area_struct *vma) {
+  int ret;
+
+  if ((vma->vm_end - vma->vm_start) > g_shm_size) {
+    return -EINVAL;
+  }
+  if (vma->vm_flags & VM_WRITE) {
+    return -EPERM;
+  }
+  // vmalloc 的页在物理上不连续，不能以首页的 pfn 做 remap_pfn_range
+  ret = remap_vmalloc_range(vma, g_shm, vma->vm_pgoff);
+  if (ret) {
+    printk(KERN_ERR "cpu_monitor: remap_vmalloc_range failed: %d\n", ret);
+  }
+  return ret;
+}
+
+static const struct file_operations cpu_monitor_fops = {
+    .owner = THIS_MODULE,
+    .open = cpu_monitor_open,
+    .read = cpu_monitor_read,
+    .poll = cpu_monitor_poll,
+    .unlocked_ioctl = cpu_monitor_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .mmap = cpu_monitor_mmap,
+};
+
+static struct miscdevice cpu_monitor_dev = {
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = CPU_MONITOR_DEVICE,
+    .fops = &cpu_monitor_fops,
+    .mode = 0444,
+};
+
+/*
+ * 计算各分段的偏移并分配共享内存：普通分段位于两个数据区内，共享分段
+ * 依次排在数据区之后。逐 CPU 分段按 nr_cpu_ids 分配，以 CPU 编号为下标，
+ * 不可能上线的 CPU 也占一行，保证 CPU 热插拔后无需重新分配；头部在初始化后只有 seq/active/timestamp_ns/
+ * interval_ns/tick 会变化
+ */
+static int cpu_monitor_alloc(void) {
+  const struct {
+    u32 id;
+    u32 nr_rows;
+    u32 row_size;
+    u32 flags;
+  } layout[NR_SECTIONS] = {
+      [SEC_LOAD] = {CPU_MONITOR_SECTION_LOAD, 1,
+                    sizeof(struct cpu_monitor_load)},
+      [SEC_STAT] = {CPU_MONITOR_SECTION_STAT, nr_cpu_ids,
+                    sizeof(struct cpu_monitor_stat)},
+      [SEC_SOFTIRQ] = {CPU_MONITOR_SECTION_SOFTIRQ, nr_cpu_ids,
+                       sizeof(struct cpu_monitor_softirq)},
+      [SEC_HISTORY] = {CPU_MONITOR_SECTION_STAT_HISTORY,
+                       CPU_MONITOR_HISTORY_DEPTH,
+                       ALIGN(sizeof(struct cpu_monitor_history_slot) +
+                                 nr_cpu_ids * sizeof(struct cpu_monitor_sample),
+                             CPU_MONITOR_ALIGN),
+                       CPU_MONITOR_SECTION_F_SHARED},
+      [SEC_BURST] = {CPU_MONITOR_SECTION_BURST, 2 * nr_cpu_ids,
+                     sizeof(struct cpu_monitor_burst),
+                     CPU_MONITOR_SECTION_F_SHARED},
+  };
+  struct cpu_monitor_section sections[NR_SECTIONS] = {};
+  u64 area_size = 0;
+  u64 shared_end;
+  u32 header_size = ALIGN(sizeof(struct cpu_monitor_header), CPU_MONITOR_ALIGN);
+  int i;
+
+  for (i = 0; i < NR_SECTIONS; ++i) {
+    sections[i].id = layout[i].id;
+    sections[i].nr_rows = layout[i].nr_rows;
+    sections[i].row_size = layout[i].row_size;
+    sections[i].flags = layout[i].flags;
+    if (layout[i].flags & CPU_MONITOR_SECTION_F_SHARED) {
+      continue;
+    }
+    sections[i].offset = area_size;
+    area_size = ALIGN(area_size + (u64)layout[i].nr_rows * layout[i].row_size,
+                      CPU_MONITOR_ALIGN);
+  }
+  shared_end = header_size + 2 * area_size;
+  for (i = 0; i < NR_SECTIONS; ++i) {
+    if (!(layout[i].flags & CPU_MONITOR_SECTION_F_SHARED)) {
+      continue;
+    }
+    sections[i].offset = shared_end;
+    shared_end = ALIGN(shared_end + (u64)layout[i].nr_rows * layout[i].row_size,
+                       CPU_MONITOR_ALIGN);
+  }
+
+  g_shm_size = PAGE_ALIGN(shared_end);
+  // vmalloc_user 分配的内存已清零，并可通过 remap_vmalloc_range 映射
+  g_shm = vmalloc_user(g_shm_size);
+  if (!g_shm) {
+    return -ENOMEM;
+  }
+  g_hdr = g_shm;
+  g_hdr->magic = CPU_MONITOR_MAGIC;
+  g_hdr->version = CPU_MONITOR_VERSION;
+  g_hdr->header_size = header_size;
+  g_hdr->nr_sections = NR_SECTIONS;
+  g_hdr->nr_cpus = nr_cpu_ids;
+  g_hdr->area_size = area_size;
+  memcpy(g_hdr->sections, sections, sizeof(sections));
+  burst_reset(burst_rows(0));
+  return 0;
+}
+
+static int __init cpu_monitor_init(void) {
+  int ret;
+
+  BUILD_BUG_ON(NR_SECTIONS > CPU_MONITOR_MAX_SECTIONS);
+  ret = cpu_monitor_alloc();
+  if (ret) {
+    printk(KERN_ERR "cpu_monitor: Failed to allocate memory\n");
+    return ret;
+  }
+
+  g_interval = ns_to_ktime(clamp_interval((u64)interval_ms * NSEC_PER_MSEC));
+
+  // 先更新一次数据
+  update_all();
+
+  // 初始化并启动定时器
+  hrtimer_init(&g_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+  g_timer.function = &cpu_monitor_timer_callback;
+  hrtimer_start(&g_timer, g_interval, HRTIMER_MODE_REL);
+
+  hrtimer_init(&g_burst_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+  g_burst_timer.function = &burst_timer_callback;
+  if (burst_ms) {
+    g_burst_interval = ms_to_ktime(burst_ms);
+    g_burst_idle_clock = get_cpu_idle_time_us(0, NULL) != -1ULL;
+    if (!g_burst_idle_clock &&
+        ktime_to_ns(g_burst_interval) <
+            (s64)CPU_MONITOR_BURST_MIN_TICKS * TICK_NSEC) {
+      g_burst_interval =
+          ns_to_ktime((u64)CPU_MONITOR_BURST_MIN_TICKS * TICK_NSEC);
+      printk(KERN_INFO
+             "cpu_monitor: NOHZ idle clock unavailable, burst window "
+             "raised to %lld ns\n",
+             ktime_to_ns(g_burst_interval));
+    }
+    g_burst_last_ns = ktime_get_ns();
+    hrtimer_start(&g_burst_timer, g_burst_interval, HRTIMER_MODE_REL);
+  }
+
+  ret = misc_register(&cpu_monitor_dev);
+  if (ret) {
+    hrtimer_cancel(&g_burst_timer);
+    hrtimer_cancel(&g_timer);
+    vfree(g_shm);
+    printk(KERN_ERR "cpu_monitor: Failed to register device\n");
+    return ret;
+  }
+
+  printk(KERN_INFO "cpu_monitor: Device registered at /dev/%s, %lu bytes\n",
+         CPU_MONITOR_DEVICE, g_shm_size);
+  return 0;
+}
+
+static void __exit cpu_monitor_exit(void) {
+  hrtimer_cancel(&g_burst_timer);
+  hrtimer_cancel(&g_timer);
+  misc_deregister(&cpu_monitor_dev);
+  if (g_shm) {
+    vfree(g_shm);
+  }
+  printk(KERN_INFO "cpu_monitor: Module unloaded\n");
+}
+
+module_init(cpu_monitor_init);
+module_exit(cpu_monitor_exit);
@@ -0,0 +1,78 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @struct CgroupStat
+ * @brief 单个 cgroup 一次采样的原始计数
+ */
+struct CgroupStat {
+  uint64_t usage_usec;
+  uint64_t user_usec;
+  uint64_t system_usec;
+  uint64_t nr_throttled;
+  uint64_t throttled_usec;
+  uint64_t memory_current; /**< 字节 */
+  uint64_t memory_anon;    /**< 字节 */
+  uint64_t memory_file;    /**< 字节 */
+  uint64_t rbytes;
+  uint64_t wbytes;
+  uint64_t rios;
+  uint64_t wios;
+  float cpu_some;
+  float memory_some;
+  float memory_full;
+  float io_some;
+  float io_full;
+};
+
+/**
+ * @class CgroupMonitor
+ * @brief cgroup v2 资源监控器
+ * 遍历 /sys/fs/cgroup 下的所有 cgroup，读取 cpu.stat、memory.current、
+ * memory.stat、io.stat 与 *.pressure。目录 fd 常驻缓存，目录树只在 inotify
+ * 报告增删时增量更新；每次只上报 CPU 与内存各自的 Top-N
+ */
+class CgroupMonitor : public MonitorInter {
+public:
+  explicit CgroupMonitor(size_t top_n = 10,
+                         const std::string &root = "/sys/fs/cgroup");
+  ~CgroupMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct CgroupEntry {
+    int dir_fd = -1;
+    int wd = -1;
+    bool has_last = false;
+    CgroupStat last{};
+  };
+
+  void FullScan();
+  void ScanSubtree(int dir_fd, const std::string &rel_path, bool deep);
+  void AddCgroup(int parent_fd, const std::string &parent_path,
+                 const char *name, bool deep);
+  void RemoveSubtree(const std::string &rel_path);
+  void DrainInotify();
+  bool ReadCgroup(int dir_fd, CgroupStat *stat);
+  std::string AbsPath(const std::string &rel_path) const;
+
+  std::string root_;
+  size_t top_n_;
+  int root_fd_ = -1;
+  int inotify_fd_ = -1;
+  // key: 相对路径
+  std::unordered_map<std::string, CgroupEntry> cgroups_;
+  // key: inotify watch descriptor, value: 相对路径（根目录为空串）
+  std::unordered_map<int, std::string> wd_map_;
+  std::chrono::steady_clock::time_point last_time_;
+  bool need_full_scan_ = false;
+};
+} // namespace yanhon
@@ -0,0 +1,163 @@
+#pragma once
+#include "cpu_monitor_shm.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct cpu_monitor_bpf;
+struct ring_buffer;
+
+namespace yanhon {
+/**
+ * @class CpuKmod
+ * @brief /dev/cpu_monitor 的共享映射，由 CPU 负载、使用率与软中断监控器共用
+ * 构造时映射一次并校验 magic/version，之后每次 Refresh 只在模块发布了新
+ * 快照（seq 变化）时复制一次活动数据区，同一周期内多个监控器读取的是
+ * 同一份一致的快照
+ *
+ * 设备在模块每次发布新快照后变为可读，直到 Refresh 复制该快照为止；
+ * 采集循环可以用 WaitFresh 等待，或把 fd() 加入自己的 epoll 集合，
+ * 从而每个快照恰好读取一次
+ *
+ * 设备不存在（模块未加载）时改为加载 bpf/cpu_monitor.bpf.c：BPF 定时器
+ * 按同样的布局写入可 mmap 的数组，读取方式不变，新快照通过 ring buffer
+ * 通知；该模式不提供历史环与突发统计
+ *
+ * BPF 也不可用时退回 procfs：Refresh 通过常驻 fd 重新读取 /proc/stat、
+ * /proc/loadavg 与 /proc/softirqs，解析成与模块相同的行，监控器的输出
+ * 不变。该模式没有刷新周期与通知，不提供历史环与突发统计
+ */
+class CpuKmod {
+public:
+  /** @brief 数据来源，kAuto 依次尝试设备、BPF 与 procfs */
+  enum class Source { kAuto, kDevice, kEbpf, kProcfs };
+
+  explicit CpuKmod(Source source = Source::kAuto);
+  ~CpuKmod();
+  CpuKmod(const CpuKmod &) = delete;
+  CpuKmod &operator=(const CpuKmod &) = delete;
+
+  bool ok() const { return hdr_ != nullptr; }
+
+  /** @brief 实际使用的数据来源，不可用时为 kAuto */
+  Source source() const { return source_; }
+
+  /**
+   * @brief 可加入 poll/epoll 集合等待 POLLIN 的 fd（设备或 ring buffer）
+   * procfs 模式下没有通知，返回 -1
+   */
+  int fd() const;
+
+  /**
+   * @brief 等待模块在调用之后发布的下一份快照
+   * 调用前已经发布的快照不算，返回 true 时数据刚刚发布，随后调用 Refresh
+   * 复制。直接 poll fd() 时，fd 从上次 Refresh 确认之后的第一次发布起
+   * 保持可读
+   * @return 超时或设备不可用时返回 false
+   */
+  bool WaitFresh(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief 更新本地快照，seq 未变化时直接复用上次的副本
+   * @return 映射不可用或多次重试仍读到撕裂的数据时返回 false
+   */
+  bool Refresh();
+
+  /**
+   * @brief 取本地快照中某一分段的行
+   * @param nr_rows 输出行数
+   * @return 分段不存在或行大小与 T 不一致时返回 nullptr
+   */
+  template <typename T>
+  const T *Rows(enum cpu_monitor_section_id id, uint32_t *nr_rows) const {
+    const struct cpu_monitor_section *sec = FindSection(id, sizeof(T), false);
+    if (!sec || snapshot_.empty()) {
+      return nullptr;
+    }
+    *nr_rows = sec->nr_rows;
+    return reinterpret_cast<const T *>(snapshot_.data() + sec->offset);
+  }
+
+  /** @brief 模块的 nr_cpu_ids，逐 CPU 分段的行数；映射不可用时为 0 */
+  uint32_t nr_cpus() const { return hdr_ ? hdr_->nr_cpus : 0; }
+
+  /** @brief 本地快照的发布时间（CLOCK_MONOTONIC 纳秒） */
+  uint64_t timestamp_ns() const { return timestamp_ns_; }
+
+  /** @brief 本地快照对应的发布次数，即历史环中最新一项的 tick */
+  uint64_t tick() const { return tick_; }
+
+  /** @brief 历史环的深度，模块不提供历史环时为 0 */
+  uint32_t HistoryDepth() const;
+
+  /**
+   * @brief 从历史环复制第 tick 次发布的一项
+   * 历史环不属于双缓冲快照，直接从映射中读取并以项内的 tick 校验
+   * @param buf 复制目标，返回值指向其中
+   * @return 该项已被覆盖、尚未写入或正在写入时返回 nullptr
+   */
+  const struct cpu_monitor_history_slot *
+  ReadHistory(uint64_t tick, std::vector<char> *buf) const;
+
+  /** @brief 发布本地快照时模块的刷新周期，未知时为 0 */
+  std::chrono::nanoseconds interval() const {
+    return std::chrono::nanoseconds(interval_ns_);
+  }
+
+  /**
+   * @brief 请求模块调整刷新周期，需要 CAP_SYS_ADMIN
+   * 模块会把周期限制在 CPU_MONITOR_INTERVAL_{MIN,MAX}_NS 之间；
+   * BPF 模式下在用户态做同样的限制，从定时器下一次触发起生效
+   * @return 实际生效的周期，失败时返回 0
+   */
+  std::chrono::nanoseconds SetInterval(std::chrono::nanoseconds interval);
+
+  /**
+   * @brief 结束模块当前的突发统计代并返回该代的逐 CPU 行
+   * 返回的行直接指向映射，在下一次调用前不会被模块改写；只应有一个调用者，
+   * 需要 CAP_SYS_ADMIN，失败一次后不再重试
+   * @param nr_rows 输出行数（模块的 nr_cpus）
+   * @return 模块未提供突发统计或调用失败时返回 nullptr
+   */
+  const struct cpu_monitor_burst *NextBurst(uint32_t *nr_rows);
+
+private:
+  bool OpenDevice();
+  bool LoadBpf();
+  void UnloadBpf();
+  bool OpenProc();
+  bool RefreshProc();
+  bool ParseStat(char *area);
+  bool ParseLoadavg(char *area);
+  bool ParseSoftirqs(char *area);
+  void Acknowledge();
+  const struct cpu_monitor_section *
+  FindSection(uint32_t id, size_t row_size, bool shared) const;
+
+  int fd_ = -1;
+  void *map_ = nullptr;
+  size_t map_size_ = 0;
+  const struct cpu_monitor_header *hdr_ = nullptr;
+  std::vector<char> snapshot_;
+  uint32_t snapshot_seq_ = 0;
+  uint64_t timestamp_ns_ = 0;
+  uint64_t interval_ns_ = 0;
+  uint64_t tick_ = 0;
+  bool burst_disabled_ = false;
+  Source source_ = Source::kAuto;
+  struct cpu_monitor_bpf *skel_ = nullptr;
+  struct ring_buffer *rb_ = nullptr;
+
+  // procfs 模式：proc_hdr_ 代替映射中的头部，缓冲区只在文件变大时扩容
+  int stat_fd_ = -1;
+  int loadavg_fd_ = -1;
+  int softirqs_fd_ = -1;
+  struct cpu_monitor_header proc_hdr_;
+  std::vector<char> proc_buf_;
+  std::vector<uint32_t> softirq_cpus_; // /proc/softirqs 各列对应的 CPU
+  std::vector<uint32_t> softirq_last_; // 按 CPU 的 32 位计数，扩展为 64 位
+  std::vector<uint64_t> softirq_total_;
+  uint64_t ns_per_tick_ = 0;
+};
+} // namespace yanhon
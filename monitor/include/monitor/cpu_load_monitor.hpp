@@ -1,18 +1,18 @@
 #pragma once
+#include "monitor/cpu_kmod.hpp"
 #include "monitor/monitor_inter.hpp"
+#include <memory>
 
 namespace yanhon {
-struct cpu_load {
-  unsigned long load_avg_1;
-  unsigned long load_avg_3;
-  unsigned long load_avg_15;
-};
-
 class CpuLoadMonitor : public MonitorInter {
 public:
-  CpuLoadMonitor() {}
+  /** @param kmod 与其他 CPU 监控器共用的映射，为空时自行打开 */
+  explicit CpuLoadMonitor(std::shared_ptr<CpuKmod> kmod = nullptr);
   ~CpuLoadMonitor() {}
   void UpdateOnce(monitor::proto::MonitorInfo *monitor_info);
   void Stop() override {}
+
+private:
+  std::shared_ptr<CpuKmod> kmod_;
 };
-} // namespace yanhon
\ No newline at end of file
+} // namespace yanhon
@@ -1,31 +1,28 @@
 #pragma once
+#include "monitor/cpu_kmod.hpp"
 #include "monitor/monitor_inter.hpp"
-#include <chrono>
-#include <string>
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
 namespace yanhon {
-using __u32 = unsigned int;
-struct softirq_stat {
-  char cpu_name[16];
-  __u32 hi;
-  __u32 timer;
-  __u32 net_tx;
-  __u32 net_rx;
-  __u32 block;
-  __u32 irq_poll;
-  __u32 tasklet;
-  __u32 sched;
-  __u32 hrtimer;
-  __u32 rcu;
-} __attribute__((packed));
-
+/**
+ * @class CpuSoftIrqMonitor
+ * @brief 每 CPU 软中断速率，数据来自 /dev/cpu_monitor 的 SOFTIRQ 分段
+ * 以模块发布快照的时间戳计算相邻两次快照之间的每秒次数，首次采集只记录
+ * 基准不输出
+ */
 class CpuSoftIrqMonitor : public MonitorInter {
 
 public:
-  CpuSoftIrqMonitor() {}
+  /** @param kmod 与其他 CPU 监控器共用的映射，为空时自行打开 */
+  explicit CpuSoftIrqMonitor(std::shared_ptr<CpuKmod> kmod = nullptr);
   ~CpuSoftIrqMonitor() {}
   void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
   void Stop() override {}
+
+private:
+  std::shared_ptr<CpuKmod> kmod_;
+  std::vector<struct cpu_monitor_softirq> last_; // 以 CPU 编号为下标
+  uint64_t last_timestamp_ns_ = 0;
 };
-} // namespace yanhon
\ No newline at end of file
+} // namespace yanhon
@@ -1,36 +1,80 @@
 #pragma once
 
+#include "monitor/cpu_kmod.hpp"
 #include "monitor/monitor_inter.hpp"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace yanhon {
 using u64 = unsigned long long;
-struct cpu_stat {
-  char cpu_name[16];
-  u64 user;
-  u64 system;
-  u64 idle;
-  u64 nice;
-  u64 io_wait;
-  u64 irq;
-  u64 soft_irq;
-  u64 steal;
-  u64 guest;
-  u64 guest_nice;
-  u64 total;
-  u64 timestamp; // 添加时间戳
-};
 
+/**
+ * @class CpuStatMonitor
+ * @brief 逻辑 CPU 使用率监控器，数据来自 /dev/cpu_monitor 的 STAT 分段
+ * 从 /sys/devices/system/cpu/cpuN/topology 读取拓扑（在线 CPU 数变化时
+ * 重新读取），每次采集在逐 CPU 结果之外按物理 socket 与物理核汇总
+ * CPU 时间增量输出聚合使用率；
+ * 逻辑 CPU 很多的机器上可以关闭逐 CPU 输出，只保留聚合结果
+ *
+ * 模块提供历史环时，逐 CPU 结果还包含上次采集以来每个刷新周期的使用率
+ * 最大/最小值，采集间隔远大于模块周期时也能看到单个周期内的尖峰；
+ * 以及模块按 10ms 级窗口采样得到的使用率最大/最小值（突发统计）
+ */
 class CpuStatMonitor : public MonitorInter {
 
 public:
-  CpuStatMonitor() {}
+  /**
+   * @param kmod 与其他 CPU 监控器共用的映射，为空时自行打开
+   * @param emit_per_cpu 是否输出逐逻辑 CPU 的 CpuStat
+   * @param emit_per_core 是否输出物理核聚合，socket 聚合总是输出
+   * @param burst 是否读取突发统计；BURST_NEXT 会结束模块的当前代，
+   *        模块只支持一个读取者，agent 以外的进程应关闭
+   */
+  explicit CpuStatMonitor(std::shared_ptr<CpuKmod> kmod = nullptr,
+                          bool emit_per_cpu = true, bool emit_per_core = true,
+                          bool burst = true);
   ~CpuStatMonitor() {}
   void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
   void Stop() {}
 
 private:
-  std::unordered_map<std::string, struct cpu_stat> cpu_stat_map_;
+  /// @brief 一个拓扑分组（socket 或物理核）
+  struct TopoGroup {
+    uint32_t socket_id;
+    int32_t core_id; /**< socket 分组为 -1 */
+    std::string name;
+  };
+  /// @brief 逻辑 CPU 所属的分组下标，-1 表示拓扑未知（例如启动时离线）
+  struct CpuTopo {
+    int32_t socket = -1;
+    int32_t core = -1;
+  };
+
+  /// @brief 上次采集以来各刷新周期使用率的范围
+  struct TickRange {
+    float max_percent = 0;
+    float min_percent = 100;
+    uint32_t ticks = 0;
+  };
+
+  void LoadTopology();
+  void ScanHistory();
+
+  std::shared_ptr<CpuKmod> kmod_;
+  bool emit_per_cpu_;
+  bool emit_per_core_;
+  bool burst_;
+  std::vector<CpuTopo> cpu_topo_; // 以 CPU 编号为下标
+  std::vector<TopoGroup> sockets_;
+  std::vector<TopoGroup> cores_;
+  uint32_t topo_online_ = 0; // 读取拓扑时的在线 CPU 数
+  std::unordered_map<std::string, struct cpu_monitor_stat> cpu_stat_map_;
+  uint64_t last_tick_ = 0;
+  std::vector<struct cpu_monitor_sample> last_samples_; // 以 CPU 编号为下标
+  std::vector<TickRange> tick_range_;                   // 以 CPU 编号为下标
+  std::vector<char> history_buf_;
 };
-} // namespace yanhon
\ No newline at end of file
+} // namespace yanhon
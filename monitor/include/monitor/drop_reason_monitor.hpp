@@ -0,0 +1,66 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct drop_reason_bpf;
+
+namespace yanhon {
+/// @brief eBPF Map drop_count 的 key，与 bpf/drop_struct.h 保持一致
+struct drop_key {
+  uint32_t ifindex;
+  uint32_t reason;
+};
+
+/**
+ * @class DropReasonMonitor
+ * @brief 按丢包原因统计的内核丢包监控
+ * eBPF 程序挂在 skb:kfree_skb 跟踪点上，以 (ifindex, drop reason) 为键在
+ * per-CPU 哈希表中计数；每次采集汇总各 CPU 的累计值并与上次相减得到速率，
+ * 按网卡输出丢包最多的 Top-N 原因。原因名称取自 vmlinux BTF 中的
+ * enum skb_drop_reason，因此能识别当前内核新增的原因
+ */
+class DropReasonMonitor : public MonitorInter {
+public:
+  /** @param top_n 每个网卡上报的原因数 */
+  explicit DropReasonMonitor(size_t top_n = 5);
+  ~DropReasonMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  bool LoadBpf();
+  void LoadReasonNames();
+  const std::string &ReasonName(uint32_t reason);
+  const std::string &InterfaceName(uint32_t ifindex);
+  void EvictStale(int map_fd);
+
+  static uint64_t Pack(const drop_key &key) {
+    return static_cast<uint64_t>(key.ifindex) << 32 | key.reason;
+  }
+  static drop_key Unpack(uint64_t packed) {
+    return {static_cast<uint32_t>(packed >> 32),
+            static_cast<uint32_t>(packed)};
+  }
+
+  struct Counter {
+    uint64_t count;       /**< 各 CPU 之和的累计丢包数 */
+    uint32_t idle_ticks;  /**< 连续没有增长的采集次数 */
+  };
+
+  struct drop_reason_bpf *skel_ = nullptr;
+  size_t top_n_;
+  int ncpus_ = 0;
+  std::vector<uint64_t> percpu_vals_;
+  std::unordered_map<uint32_t, std::string> reason_names_;
+  std::unordered_map<uint32_t, std::string> if_names_;
+  // key 为 Pack(drop_key)
+  std::unordered_map<uint64_t, Counter> last_;
+  std::chrono::steady_clock::time_point last_time_;
+  bool has_last_ = false;
+};
+} // namespace yanhon
@@ -0,0 +1,59 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @struct MountEntry
+ * @brief mountinfo 中的一个挂载点，同一设备只保留一个
+ */
+struct MountEntry {
+  uint64_t dev; /**< makedev(major, minor) */
+  std::string mount_point;
+  std::string fs_type;
+  std::string source;
+  bool root; /**< 挂载的是文件系统根目录而不是 bind 的子目录 */
+};
+
+/**
+ * @class FsMonitor
+ * @brief 文件系统容量与 inode 监控器
+ * 常驻打开 /proc/self/mountinfo 并缓存解析结果，只有 poll() 返回
+ * POLLPRI/POLLERR（挂载表发生变化）时才重新解析，容器宿主机上数千个
+ * 挂载点时避免每次采集都解析整张表。只对需要块设备的文件系统
+ * （/proc/filesystems 中不带 nodev 的类型）调用 statvfs，同一设备的
+ * bind 挂载只统计一次；网络文件系统为 nodev，不会因服务端无响应而阻塞采集
+ */
+class FsMonitor : public MonitorInter {
+public:
+  FsMonitor();
+  ~FsMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct Usage {
+    uint64_t used_bytes = 0;
+    double fill_rate = 0; /**< 平滑后的增长速率，字节/秒 */
+  };
+
+  void LoadNodevTypes();
+  bool MountsChanged();
+  void ParseMountInfo();
+
+  int mountinfo_fd_ = -1;
+  std::vector<char> buf_;
+  std::unordered_set<std::string> nodev_types_;
+  std::vector<MountEntry> mounts_;
+  bool mounts_valid_ = false;
+  // 以设备号为键，挂载点重新解析后仍能延续增长速率
+  std::unordered_map<uint64_t, Usage> usage_;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
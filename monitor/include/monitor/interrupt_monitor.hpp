@@ -0,0 +1,42 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @class InterruptMonitor
+ * @brief 硬中断分布监控器，解析 /proc/interrupts 计算每个中断在各 CPU 上的速率
+ * 多核机器上 /proc/interrupts 每行有上百列计数，解析时用 SSE2 一次检查
+ * 16 字节来跳过空格、定位数字结尾；只输出最活跃的 Top-N 中断及其不均衡度，
+ * 用于发现网卡队列中断全部绑在少数 CPU 上之类的亲和性问题
+ */
+class InterruptMonitor : public MonitorInter {
+public:
+  explicit InterruptMonitor(size_t top_n = 10);
+  ~InterruptMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  bool Read();
+  bool ParseHeader(const char *p, const char *end);
+
+  int fd_ = -1;
+  size_t top_n_;
+  std::vector<char> buf_;
+  size_t len_ = 0;
+  std::vector<int32_t> cpus_; // 表头中的 CPU 编号
+  // 本次与上次的计数矩阵，行对应 labels_，列对应 cpus_
+  std::vector<std::string> labels_;
+  std::vector<std::string> last_labels_;
+  std::vector<uint64_t> counts_;
+  std::vector<uint64_t> last_counts_;
+  std::vector<size_t> desc_offset_; // 每行描述文字在 buf_ 中的位置
+  bool has_last_ = false;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
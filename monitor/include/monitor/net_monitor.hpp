@@ -15,7 +15,14 @@ struct NetInfo {
   uint64_t err_out;  // 新增: 发送错误计数，辅助判断链路质量
   uint64_t drop_in;  // 新增: 接收丢弃数，反映内核队列压力
   uint64_t drop_out; // 新增: 发送丢弃数，判断应用层处理能力
+  uint64_t qdisc_bytes;
+  uint64_t qdisc_drops;
+  uint64_t qdisc_overlimits;
+  uint64_t qdisc_requeues;
   std::chrono::steady_clock::time_point timepoint;
+  // qdisc 基线单独记录时间，某次 dump 缺少该网卡时保留上次的基线
+  bool has_qdisc = false;
+  std::chrono::steady_clock::time_point qdisc_timepoint;
 };
 
 struct NetStat {
@@ -30,6 +37,17 @@ struct NetStat {
   uint64_t drop_out; // 新增: 发送丢弃数，判断应用层处理能力
 };
 
+/// @brief 出方向根 qdisc 的统计，来自 netlink RTM_GETQDISC 的 TCA_STATS2
+struct QdiscStat {
+  std::string kind;
+  uint64_t bytes;      // 累计出队字节数
+  uint32_t backlog;    // 当前排队字节数
+  uint32_t qlen;       // 当前排队包数
+  uint64_t drops;      // 累计丢包数
+  uint64_t overlimits; // 累计超限次数
+  uint64_t requeues;   // 累计重新入队次数
+};
+
 /// @brief eBPF Map 中存储的统计数据结构 (只关心流量和包数)
 struct if_counters {
   __u64 rcv_bytes;
@@ -49,6 +67,7 @@ public:
 
 private:
   std::unordered_map<std::string, if_counters> ebpf_get_net_stats();
+  std::unordered_map<std::string, QdiscStat> netlink_get_qdisc_stats();
   // key: 网卡名
   std::unordered_map<std::string, NetInfo> last_net_info_;
 
@@ -64,5 +83,8 @@ private:
   bool *hooks_created_egress = NULL;
   struct if_counters total = {0};
   bool bpf_loaded = false;
+  // 常驻的 NETLINK_ROUTE socket，用于每次 dump qdisc
+  int qdisc_sock_ = -1;
+  uint32_t qdisc_seq_ = 0;
 };
 } // namespace yanhon
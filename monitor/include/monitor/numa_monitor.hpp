@@ -0,0 +1,48 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @struct NumaStat
+ * @brief /sys/devices/system/node/nodeN/numastat 的累计计数（单位：页）
+ */
+struct NumaStat {
+  uint64_t numa_hit;
+  uint64_t numa_miss;
+  uint64_t numa_foreign;
+  uint64_t interleave_hit;
+  uint64_t local_node;
+  uint64_t other_node;
+};
+
+/**
+ * @class NumaMonitor
+ * @brief NUMA 节点监控器
+ * 启动时枚举 /sys/devices/system/node/node*，为每个节点常驻打开 meminfo
+ * 与 numastat，每次采集输出节点内存用量以及分配命中/未命中速率，
+ * 用于发现单节点内存耗尽与跨节点访问
+ */
+class NumaMonitor : public MonitorInter {
+public:
+  NumaMonitor();
+  ~NumaMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct Node {
+    uint32_t id;
+    int meminfo_fd = -1;
+    int numastat_fd = -1;
+    bool has_last = false;
+    NumaStat last{};
+  };
+
+  std::vector<Node> nodes_;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
@@ -0,0 +1,57 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct page_cache_bpf;
+
+namespace yanhon {
+/// @brief eBPF Map cache_stat 中的值，与 bpf/cache_struct.h 保持一致
+struct page_cache_stat {
+  unsigned long long lookups;
+  unsigned long long misses;
+};
+
+/**
+ * @class PageCacheMonitor
+ * @brief 页缓存命中率监控器
+ * eBPF 以 fexit 挂在 filemap_get_read_batch 上统计读路径命中的 folio 数，
+ * 以 fentry 挂在 filemap_add_folio 上统计新插入的 folio 数，命中 = 查找 -
+ * 插入。两个计数都只在 filemap_read 期间统计：写路径创建的 folio 与 mmap
+ * 缺页读入的 folio 没有对应的查找，计入未命中会压低命中率
+ *
+ * cachestat(2) 只能给出指定文件的驻留与淘汰情况，无法统计系统级的查找次数，
+ * 因此用于补充：对 watch_files 中的文件（例如数据库数据文件）输出驻留比例
+ * 与最近被淘汰的页数，内核不支持（ENOSYS）时跳过
+ */
+class PageCacheMonitor : public MonitorInter {
+public:
+  explicit PageCacheMonitor(std::vector<std::string> watch_files = {});
+  ~PageCacheMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct WatchFile {
+    std::string path;
+    int fd = -1;
+    uint64_t last_evicted = 0;
+    bool has_last = false;
+  };
+
+  bool LoadBpf();
+  void UpdateFiles(monitor::proto::PageCacheInfo *cache_msg, double dt);
+
+  struct page_cache_bpf *skel_ = nullptr;
+  std::vector<page_cache_stat> percpu_vals_;
+  page_cache_stat last_{};
+  bool has_last_ = false;
+  std::vector<WatchFile> files_;
+  bool cachestat_ok_ = true;
+  long page_size_;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
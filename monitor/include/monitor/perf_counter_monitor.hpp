@@ -0,0 +1,64 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @enum PerfCounter
+ * @brief 采集的 perf 事件，前四个为硬件事件，其余为软件事件
+ */
+enum PerfCounter : int8_t {
+  kCycles,
+  kInstructions,
+  kLlcMisses,
+  kBranchMisses,
+  kContextSwitches,
+  kCpuMigrations,
+  kPageFaults,
+  kPerfCounterCount,
+};
+
+/**
+ * @class PerfCounterMonitor
+ * @brief 基于 perf_event_open 的 CPU 性能计数监控器
+ * 每个 CPU 打开一个事件组（PERF_FORMAT_GROUP），组内包含 cycles、
+ * instructions、LLC miss、branch miss 以及上下文切换、迁移、缺页等软件事件，
+ * 每次采集对每个 CPU 只做一次 read()。硬件 PMU 不可用时（例如虚拟机）
+ * 由软件事件担任组长，只输出软件计数
+ *
+ * 需要 CAP_PERFMON（或 perf_event_paranoid <= 0），否则不输出任何数据
+ */
+class PerfCounterMonitor : public MonitorInter {
+public:
+  /**
+   * @param emit_per_cpu 是否输出逐 CPU 计数，汇总项总是输出
+   */
+  explicit PerfCounterMonitor(bool emit_per_cpu = true);
+  ~PerfCounterMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct CpuGroup {
+    int cpu;
+    std::vector<int> fds; // fds[0] 为组长
+    uint64_t last[kPerfCounterCount] = {};
+    uint64_t last_enabled = 0;
+    uint64_t last_running = 0;
+    bool has_last = false;
+  };
+
+  bool OpenGroup(int cpu, CpuGroup *group);
+
+  bool emit_per_cpu_;
+  bool hardware_ = false;
+  // 组内第 i 个事件对应的计数，所有 CPU 的组布局相同
+  std::vector<PerfCounter> layout_;
+  std::vector<CpuGroup> groups_;
+  std::vector<uint64_t> read_buf_;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
@@ -0,0 +1,78 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @struct PsiLine
+ * @brief /proc/pressure/<resource> 中一行（some 或 full）的解析结果
+ */
+struct PsiLine {
+  float avg10;    /**< 10 秒窗口停顿占比 */
+  float avg60;    /**< 60 秒窗口停顿占比 */
+  float avg300;   /**< 300 秒窗口停顿占比 */
+  uint64_t total; /**< 累计停顿时间（微秒） */
+};
+
+/**
+ * @brief 解析一行 PSI 数据，例如 "some avg10=0.12 avg60=0.05 avg300=0.01
+ * total=123456"，/proc/pressure 与 cgroup 的 *.pressure 格式相同
+ * @param kind 期望的行首 "some" 或 "full"
+ * @return 成功返回下一行起始位置，失败返回 nullptr
+ */
+const char *ParsePsiLine(const char *p, const char *end, const char *kind,
+                         PsiLine *out);
+
+/**
+ * @class PressureMonitor
+ * @brief PSI（Pressure Stall Information）监控器
+ * 周期性读取 /proc/pressure/{cpu,memory,io}，并注册 PSI 触发器，
+ * 当停顿超过阈值时由 WaitForStall 提前唤醒采集循环，捕获亚秒级的停顿事件
+ */
+class PressureMonitor : public MonitorInter {
+public:
+  /**
+   * @brief 构造函数
+   * @param stall_threshold_us 触发窗口内累计停顿超过该值（微秒）即触发
+   * @param window_us 触发器统计窗口（微秒），内核要求 500ms~10s
+   */
+  explicit PressureMonitor(uint32_t stall_threshold_us = 150000,
+                           uint32_t window_us = 1000000);
+  ~PressureMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+
+  /** @brief 关闭所有 PSI 文件描述符与触发器 */
+  void Stop() override;
+
+  /**
+   * @brief 在 PSI 触发器上等待，替代采集循环中的固定 sleep
+   * @param timeout 最长等待时间
+   * @return 任一触发器在超时前触发时返回 true，调用方应立即采集并上报
+   */
+  bool WaitForStall(std::chrono::milliseconds timeout);
+
+private:
+  struct Resource {
+    std::string name;
+    int fd = -1;         /**< 持久打开的读取 fd，每次用 pread 从头读取 */
+    int trigger_fd = -1; /**< 注册了触发器的 fd，poll 等待 POLLPRI */
+    bool has_full = false;
+    bool triggered = false;
+    bool has_last = false;
+    PsiLine last_some{};
+    PsiLine last_full{};
+    std::chrono::steady_clock::time_point last_time;
+  };
+
+  int RegisterTrigger(const std::string &path, const char *kind);
+
+  std::vector<Resource> resources_;
+  uint32_t stall_threshold_us_;
+  uint32_t window_us_;
+  bool triggered_ = false;
+};
+} // namespace yanhon
@@ -0,0 +1,137 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct proc_cpu_bpf;
+
+namespace yanhon {
+/// @brief eBPF Map tgid_cpu 中的值，与 bpf/proc_struct.h 保持一致
+struct proc_cpu_val {
+  unsigned long long on_cpu_ns;
+  char comm[16];
+};
+
+/// @brief eBPF Map switch_start 中每个 CPU 的值，与 bpf/proc_struct.h 保持一致
+struct proc_cpu_slot {
+  unsigned long long start;
+  uint32_t tgid;
+  uint32_t reserved;
+};
+
+/**
+ * @struct ProcSlot
+ * @brief 进程状态表中的一个槽位，保存上次采样的累计值用于计算差值
+ */
+struct ProcSlot {
+  int32_t pid;          /**< 0 表示空槽，-1 表示已删除（墓碑） */
+  uint32_t seen_tick;   /**< 最近一次被扫描到的 tick */
+  uint64_t start_time;  /**< 进程启动时间，用于识别 pid 复用 */
+  uint64_t cpu_ticks;   /**< utime + stime */
+  uint64_t read_bytes;  /**< /proc/[pid]/io 的 read_bytes */
+  uint64_t write_bytes; /**< /proc/[pid]/io 的 write_bytes */
+  uint64_t rss_pages;
+  uint32_t num_threads;
+  uint32_t cpu_delta;     /**< 本周期 CPU ticks 增量 */
+  uint64_t io_delta;      /**< 本周期读写字节增量 */
+  uint64_t read_delta;
+  uint64_t write_delta;
+  int64_t io_time_ns;     /**< 上次读取 /proc/[pid]/io 的时间 */
+  float io_dt;            /**< io 增量覆盖的时长（秒），可能跨越多个周期 */
+  bool has_io;
+  char comm[16];
+};
+
+/**
+ * @class PidTable
+ * @brief 以 pid 为键的开放寻址哈希表（线性探测），槽位连续存放，
+ * 避免 2 万以上进程时 unordered_map 的逐节点分配
+ */
+class PidTable {
+public:
+  explicit PidTable(size_t capacity = 4096);
+
+  /** @brief 查找 pid，不存在则插入一个清零的槽位 */
+  ProcSlot *FindOrInsert(int32_t pid, bool *inserted);
+
+  /** @brief 删除 seen_tick 不等于 tick 的槽位（进程已退出） */
+  void Sweep(uint32_t tick);
+
+  size_t size() const { return size_; }
+  std::vector<ProcSlot> &slots() { return slots_; }
+
+private:
+  void Rehash(size_t capacity);
+
+  std::vector<ProcSlot> slots_;
+  size_t size_ = 0;
+  size_t tombstones_ = 0;
+};
+
+/**
+ * @class ProcessMonitor
+ * @brief 进程级 Top-N 监控器
+ * 通过缓存的 /proc 目录 fd 与 getdents64 枚举进程，openat 读取
+ * /proc/[pid]/stat；只有 CPU 时间发生变化的进程才读取 /proc/[pid]/io，
+ * statm 只对 RSS Top-N 读取。输出按 CPU、RSS、I/O 排序的 Top-N
+ *
+ * eBPF 模式下由 sched_switch 跟踪点按 tgid 累加在 CPU 上的纳秒数，
+ * 每次采集取走并清空 Map，开销只与活跃进程数相关，不再访问 /proc/[pid]；
+ * 尚未切出的运行片段在采集时按已运行的时长计入，长期独占 CPU 的进程
+ * 也能逐周期看到；
+ * 该模式只输出 CPU Top-N，加载失败时自动退回 /proc 扫描
+ */
+class ProcessMonitor : public MonitorInter {
+public:
+  enum class Source { kProcfs, kEbpf };
+
+  /**
+   * @param top_n 每个排序维度上报的进程数
+   * @param budget_us 单次扫描耗时预算（微秒），超出后本次不再读取 I/O 统计
+   * @param source 数据来源
+   */
+  explicit ProcessMonitor(size_t top_n = 10, uint32_t budget_us = 50000,
+                          Source source = Source::kProcfs);
+  ~ProcessMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  bool ReadStat(int32_t pid, ProcSlot *slot, bool inserted);
+  void ReadIo(int32_t pid, ProcSlot *slot, int64_t now_ns);
+  bool LoadBpf();
+  void UpdateFromBpf(monitor::proto::MonitorInfo *monitor_info);
+  void CreditRunning(std::vector<std::pair<uint32_t, proc_cpu_val>> *drained);
+
+  int proc_fd_ = -1;
+  PidTable table_;
+  uint32_t tick_ = 0;
+  size_t top_n_;
+  uint32_t budget_us_;
+  long clk_tck_;
+  long page_size_;
+  std::vector<char> dents_buf_;
+  std::chrono::steady_clock::time_point last_time_;
+  struct proc_cpu_bpf *skel_ = nullptr;
+  std::vector<uint32_t> bpf_keys_;
+  std::vector<proc_cpu_val> bpf_vals_;
+
+  /// @brief 某个 CPU 上正在运行、已被提前计入的片段
+  struct RunningSlice {
+    uint64_t start = 0;
+    uint32_t tgid = 0;
+    uint64_t credited = 0; /**< 已计入的纳秒数 */
+  };
+  /// @brief 片段切出后 Map 中会包含其全长，已提前计入的部分需要扣除
+  struct Debt {
+    uint64_t ns = 0;
+    uint32_t age = 0; /**< 未能扣完的采集次数 */
+  };
+  std::vector<proc_cpu_slot> slot_vals_; // 以 CPU 编号为下标
+  std::vector<RunningSlice> running_;
+  std::unordered_map<uint32_t, Debt> debts_;
+};
+} // namespace yanhon
@@ -0,0 +1,95 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @enum ProtoStatField
+ * @brief 采集的协议栈计数，对应 /proc/net/snmp 与 /proc/net/netstat 中的列
+ */
+enum ProtoStatField : int16_t {
+  kIpInDiscards,
+  kIpOutDiscards,
+  kIpOutNoRoutes,
+  kIpReasmFails,
+  kTcpActiveOpens,
+  kTcpPassiveOpens,
+  kTcpAttemptFails,
+  kTcpEstabResets,
+  kTcpCurrEstab,
+  kTcpInSegs,
+  kTcpOutSegs,
+  kTcpRetransSegs,
+  kTcpInErrs,
+  kTcpOutRsts,
+  kTcpInCsumErrors,
+  kUdpInDatagrams,
+  kUdpOutDatagrams,
+  kUdpNoPorts,
+  kUdpInErrors,
+  kUdpRcvbufErrors,
+  kUdpSndbufErrors,
+  kUdpInCsumErrors,
+  kUdpMemErrors,
+  kListenOverflows,
+  kListenDrops,
+  kTcpBacklogDrop,
+  kTcpReqQFullDrop,
+  kSyncookiesSent,
+  kTcpTimeouts,
+  kTcpSynRetrans,
+  kTcpFastRetrans,
+  kTcpLostRetransmit,
+  kTcpAbortOnMemory,
+  kTcpAbortOnTimeout,
+  kTcpMemoryPressures,
+  kTcpRcvQDrop,
+  kTcpZeroWindowDrop,
+  kPruneCalled,
+  kTw,
+  kProtoStatFieldCount,
+};
+
+/**
+ * @struct SnmpPairIndex
+ * @brief 一对表头/数值行的列映射
+ */
+struct SnmpPairIndex {
+  std::string prefix;                // 例如 "Tcp:"
+  std::vector<int16_t> column_field; // -1 表示不关心
+};
+
+/**
+ * @class ProtoStatsMonitor
+ * @brief TCP/UDP 协议栈计数监控器
+ * /proc/net/snmp 与 /proc/net/netstat 由成对的行组成：
+ * "Tcp: RtoAlgorithm RtoMin ..." 与 "Tcp: 1 200 ..."。两个文件都保持常驻 fd，
+ * 首次读取时由表头行建立 "列 -> 字段" 的映射，之后只解析数值行
+ */
+class ProtoStatsMonitor : public MonitorInter {
+public:
+  ProtoStatsMonitor();
+  ~ProtoStatsMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct ProcFile {
+    const char *path;
+    int fd = -1;
+    std::vector<char> buf;
+    std::vector<SnmpPairIndex> index;
+  };
+
+  bool ReadFile(ProcFile *file, uint64_t *values);
+
+  ProcFile files_[2];
+  uint64_t last_[kProtoStatFieldCount] = {};
+  bool has_last_ = false;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
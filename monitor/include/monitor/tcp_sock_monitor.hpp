@@ -0,0 +1,53 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct inet_diag_msg;
+
+namespace yanhon {
+/**
+ * @class TcpSockMonitor
+ * @brief 基于 NETLINK_SOCK_DIAG 的 TCP socket 统计
+ * 以 inet_diag 请求 dump 全部 IPv4/IPv6 TCP socket 并携带 INET_DIAG_INFO
+ * （二进制 tcp_info），每收到一条消息立即累加到状态计数、监听端口队列和
+ * RTT/cwnd 直方图中，不保存单个 socket；10 万以上连接时仍远快于解析
+ * /proc/net/tcp
+ */
+class TcpSockMonitor : public MonitorInter {
+public:
+  static constexpr int kHistBuckets = 24;
+
+  explicit TcpSockMonitor(size_t top_listen = 10);
+  ~TcpSockMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  struct ListenQueue {
+    uint32_t sockets = 0;
+    uint32_t queue = 0;
+    uint32_t backlog = 0;
+  };
+
+  bool Dump(int family);
+  void Aggregate(const struct inet_diag_msg *msg, int len);
+
+  int fd_ = -1;
+  size_t top_listen_;
+  std::vector<char> buf_;
+  uint32_t seq_ = 0;
+
+  // 本次采集的聚合结果
+  uint32_t state_count_[16];
+  uint32_t rtt_hist_[kHistBuckets];
+  uint32_t cwnd_hist_[kHistBuckets];
+  uint32_t retransmitting_;
+  uint64_t unacked_;
+  uint64_t send_queue_bytes_;
+  uint64_t recv_queue_bytes_;
+  std::unordered_map<uint16_t, ListenQueue> listen_;
+};
+} // namespace yanhon
@@ -0,0 +1,79 @@
+#pragma once
+#include "monitor/monitor_inter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace yanhon {
+/**
+ * @enum VmStatField
+ * @brief 采集的 /proc/vmstat 计数，多个 key 可以累加到同一个字段
+ * （例如 allocstall_normal 与 allocstall_movable 合并为 kAllocstall）
+ */
+enum VmStatField : int16_t {
+  kPgfault,
+  kPgmajfault,
+  kPgpgin,
+  kPgpgout,
+  kPswpin,
+  kPswpout,
+  kPgscanKswapd,
+  kPgscanDirect,
+  kPgstealKswapd,
+  kPgstealDirect,
+  kAllocstall,
+  kPgrefill,
+  kPgrotated,
+  kSlabsScanned,
+  kKswapdInodesteal,
+  kPageoutrun,
+  kWorkingsetRefaultAnon,
+  kWorkingsetRefaultFile,
+  kWorkingsetActivateAnon,
+  kWorkingsetActivateFile,
+  kPgalloc,
+  kPgfree,
+  kPgactivate,
+  kPgdeactivate,
+  kCompactStall,
+  kCompactFail,
+  kCompactSuccess,
+  kPgmigrateSuccess,
+  kPgmigrateFail,
+  kThpFaultAlloc,
+  kThpFaultFallback,
+  kOomKill,
+  kNrDirtied,
+  kNrWritten,
+  kVmStatFieldCount,
+};
+
+/**
+ * @class VmStatMonitor
+ * @brief 内存活动监控器，将 /proc/vmstat 中约 30 个累计计数转换为每秒速率
+ * /proc/vmstat 保持常驻 fd，每次用 pread 从头读取；首次读取时建立
+ * "行号 -> 字段" 的映射表，之后按行号直接定位，不再逐行比较字符串
+ */
+class VmStatMonitor : public MonitorInter {
+public:
+  VmStatMonitor();
+  ~VmStatMonitor();
+
+  void UpdateOnce(monitor::proto::MonitorInfo *monitor_info) override;
+  void Stop() override;
+
+private:
+  bool ReadCounters(uint64_t *values);
+  void BuildIndex(const char *buf, const char *end);
+
+  int fd_ = -1;
+  std::vector<char> buf_;
+  // 第 i 行对应的字段，-1 表示不关心
+  std::vector<int16_t> line_field_;
+  // 第 i 行 key 的长度，用于校验行布局是否变化
+  std::vector<uint16_t> line_key_len_;
+  uint64_t last_[kVmStatFieldCount] = {};
+  bool has_last_ = false;
+  std::chrono::steady_clock::time_point last_time_;
+};
+} // namespace yanhon
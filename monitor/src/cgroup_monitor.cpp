@@ -0,0 +1,419 @@
+#include "monitor/cgroup_monitor.hpp"
+#include "monitor/pressure_monitor.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace yanhon {
+static constexpr float BToMB = 1024 * 1024;
+static constexpr uint32_t kWatchMask =
+    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+/**
+ * @brief 相对目录 fd 读取一个小文件到 buf，文件内容以 '\0' 结尾
+ * @return 读取的字节数，失败返回 -1
+ */
+static ssize_t read_at(int dir_fd, const char *name, char *buf, size_t size) {
+  int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t n = read(fd, buf, size - 1);
+  close(fd);
+  if (n < 0) {
+    return -1;
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+/**
+ * @brief 在 "key value\n" 格式的内容中查找 key 对应的值
+ */
+static uint64_t find_kv(const char *buf, const char *key) {
+  size_t key_len = strlen(key);
+  const char *p = buf;
+  while (p && *p) {
+    if (strncmp(p, key, key_len) == 0 && p[key_len] == ' ') {
+      return strtoull(p + key_len + 1, nullptr, 10);
+    }
+    p = strchr(p, '\n');
+    if (p)
+      ++p;
+  }
+  return 0;
+}
+
+/** @brief 累计计数的增量，计数回退（同一路径的 cgroup 被重建）时为 0 */
+static uint64_t counter_delta(uint64_t cur, uint64_t last) {
+  return cur >= last ? cur - last : 0;
+}
+
+/**
+ * @brief 累加 io.stat 中所有设备的读写字节与次数，每行形如
+ * "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0"
+ */
+static void parse_io_stat(const char *buf, CgroupStat *stat) {
+  const char *p = buf;
+  while (*p) {
+    const char *eol = strchr(p, '\n');
+    if (!eol)
+      eol = p + strlen(p);
+    for (const char *q = strchr(p, ' '); q && q < eol; q = strchr(q, ' ')) {
+      ++q;
+      const char *eq = strchr(q, '=');
+      if (!eq || eq >= eol)
+        break;
+      uint64_t v = strtoull(eq + 1, nullptr, 10);
+      size_t klen = eq - q;
+      if (klen == 6 && strncmp(q, "rbytes", 6) == 0) {
+        stat->rbytes += v;
+      } else if (klen == 6 && strncmp(q, "wbytes", 6) == 0) {
+        stat->wbytes += v;
+      } else if (klen == 4 && strncmp(q, "rios", 4) == 0) {
+        stat->rios += v;
+      } else if (klen == 4 && strncmp(q, "wios", 4) == 0) {
+        stat->wios += v;
+      }
+    }
+    p = *eol ? eol + 1 : eol;
+  }
+}
+
+static void read_pressure(int dir_fd, const char *name, float *some,
+                          float *full) {
+  char buf[256];
+  ssize_t n = read_at(dir_fd, name, buf, sizeof(buf));
+  if (n <= 0) {
+    return;
+  }
+  PsiLine line{};
+  const char *p = ParsePsiLine(buf, buf + n, "some", &line);
+  if (!p) {
+    return;
+  }
+  *some = line.avg10;
+  if (full && ParsePsiLine(p, buf + n, "full", &line)) {
+    *full = line.avg10;
+  }
+}
+
+CgroupMonitor::CgroupMonitor(size_t top_n, const std::string &root)
+    : root_(root), top_n_(top_n) {
+  root_fd_ = open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (root_fd_ < 0) {
+    std::cerr << "Failed to open " << root_ << ": " << strerror(errno)
+              << std::endl;
+    return;
+  }
+  // 只支持 cgroup v2（unified hierarchy）
+  if (faccessat(root_fd_, "cgroup.controllers", R_OK, 0) != 0) {
+    std::cerr << root_ << " is not a cgroup v2 mount" << std::endl;
+    close(root_fd_);
+    root_fd_ = -1;
+    return;
+  }
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    std::cerr << "inotify_init1 failed, cgroup tree rescanned every tick"
+              << std::endl;
+  }
+  FullScan();
+  last_time_ = std::chrono::steady_clock::now();
+}
+
+CgroupMonitor::~CgroupMonitor() { Stop(); }
+
+std::string CgroupMonitor::AbsPath(const std::string &rel_path) const {
+  return rel_path.empty() ? root_ : root_ + "/" + rel_path;
+}
+
+void CgroupMonitor::FullScan() {
+  if (inotify_fd_ >= 0 && wd_map_.empty()) {
+    int wd = inotify_add_watch(inotify_fd_, root_.c_str(), kWatchMask);
+    if (wd >= 0)
+      wd_map_[wd] = "";
+  }
+  // 已知的 cgroup 保留 fd 与上次计数，只补充新出现的目录；
+  // 已删除的目录在 UpdateOnce 读取失败时清理
+  ScanSubtree(root_fd_, "", true);
+  need_full_scan_ = false;
+}
+
+void CgroupMonitor::ScanSubtree(int dir_fd, const std::string &rel_path,
+                                bool deep) {
+  // fdopendir 会接管 fd，这里 dup 一份以保留缓存的目录 fd
+  int dup_fd = dup(dir_fd);
+  if (dup_fd < 0) {
+    return;
+  }
+  DIR *dir = fdopendir(dup_fd);
+  if (!dir) {
+    close(dup_fd);
+    return;
+  }
+  std::vector<std::string> children;
+  while (struct dirent *de = readdir(dir)) {
+    if (de->d_type != DT_DIR || de->d_name[0] == '.') {
+      continue;
+    }
+    children.emplace_back(de->d_name);
+  }
+  closedir(dir);
+
+  for (const auto &name : children) {
+    AddCgroup(dir_fd, rel_path, name.c_str(), deep);
+  }
+}
+
+void CgroupMonitor::AddCgroup(int parent_fd, const std::string &parent_path,
+                              const char *name, bool deep) {
+  std::string rel_path =
+      parent_path.empty() ? name : parent_path + "/" + name;
+  auto it = cgroups_.find(rel_path);
+  if (it != cgroups_.end()) {
+    if (deep) {
+      ScanSubtree(it->second.dir_fd, rel_path, true);
+    }
+    return;
+  }
+  int fd = openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  CgroupEntry entry;
+  entry.dir_fd = fd;
+  if (inotify_fd_ >= 0) {
+    entry.wd =
+        inotify_add_watch(inotify_fd_, AbsPath(rel_path).c_str(), kWatchMask);
+    if (entry.wd >= 0)
+      wd_map_[entry.wd] = rel_path;
+  }
+  cgroups_[rel_path] = entry;
+  ScanSubtree(fd, rel_path, deep);
+}
+
+void CgroupMonitor::RemoveSubtree(const std::string &rel_path) {
+  std::string prefix = rel_path + "/";
+  for (auto it = cgroups_.begin(); it != cgroups_.end();) {
+    if (it->first == rel_path ||
+        it->first.compare(0, prefix.size(), prefix) == 0) {
+      close(it->second.dir_fd);
+      if (inotify_fd_ >= 0 && it->second.wd >= 0)
+        inotify_rm_watch(inotify_fd_, it->second.wd);
+      it = cgroups_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void CgroupMonitor::DrainInotify() {
+  if (inotify_fd_ < 0) {
+    // 没有 inotify 时退化为每次全量扫描
+    need_full_scan_ = true;
+    return;
+  }
+  alignas(struct inotify_event) char buf[4096];
+  while (true) {
+    ssize_t len = read(inotify_fd_, buf, sizeof(buf));
+    if (len <= 0) {
+      break;
+    }
+    for (char *p = buf; p < buf + len;) {
+      auto *ev = reinterpret_cast<struct inotify_event *>(p);
+      p += sizeof(struct inotify_event) + ev->len;
+
+      if (ev->mask & IN_Q_OVERFLOW) {
+        need_full_scan_ = true;
+        continue;
+      }
+      if (ev->mask & IN_IGNORED) {
+        wd_map_.erase(ev->wd);
+        continue;
+      }
+      if (!(ev->mask & IN_ISDIR) || ev->len == 0) {
+        continue;
+      }
+      auto wit = wd_map_.find(ev->wd);
+      if (wit == wd_map_.end()) {
+        continue;
+      }
+      const std::string parent = wit->second;
+      std::string child =
+          parent.empty() ? ev->name : parent + "/" + ev->name;
+      if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+        int parent_fd = root_fd_;
+        if (!parent.empty()) {
+          auto pit = cgroups_.find(parent);
+          parent_fd = pit == cgroups_.end() ? -1 : pit->second.dir_fd;
+        }
+        if (parent_fd >= 0) {
+          AddCgroup(parent_fd, parent, ev->name, false);
+        }
+      } else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        RemoveSubtree(child);
+      }
+    }
+  }
+}
+
+bool CgroupMonitor::ReadCgroup(int dir_fd, CgroupStat *stat) {
+  char buf[4096];
+  *stat = CgroupStat{};
+
+  if (read_at(dir_fd, "cpu.stat", buf, sizeof(buf)) < 0) {
+    // 目录已被删除但 inotify 事件尚未处理
+    return false;
+  }
+  stat->usage_usec = find_kv(buf, "usage_usec");
+  stat->user_usec = find_kv(buf, "user_usec");
+  stat->system_usec = find_kv(buf, "system_usec");
+  stat->nr_throttled = find_kv(buf, "nr_throttled");
+  stat->throttled_usec = find_kv(buf, "throttled_usec");
+
+  if (read_at(dir_fd, "memory.current", buf, sizeof(buf)) > 0) {
+    stat->memory_current = strtoull(buf, nullptr, 10);
+  }
+  if (read_at(dir_fd, "memory.stat", buf, sizeof(buf)) > 0) {
+    stat->memory_anon = find_kv(buf, "anon");
+    stat->memory_file = find_kv(buf, "file");
+  }
+  if (read_at(dir_fd, "io.stat", buf, sizeof(buf)) > 0) {
+    parse_io_stat(buf, stat);
+  }
+  read_pressure(dir_fd, "cpu.pressure", &stat->cpu_some, nullptr);
+  read_pressure(dir_fd, "memory.pressure", &stat->memory_some,
+                &stat->memory_full);
+  read_pressure(dir_fd, "io.pressure", &stat->io_some, &stat->io_full);
+  return true;
+}
+
+void CgroupMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (root_fd_ < 0) {
+    return;
+  }
+  DrainInotify();
+  if (need_full_scan_) {
+    FullScan();
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  double dt_us =
+      std::chrono::duration<double, std::micro>(now - last_time_).count();
+  double dt = dt_us / 1e6;
+  last_time_ = now;
+
+  struct Sample {
+    const std::string *path;
+    CgroupStat cur;
+    CgroupStat last;
+    bool has_last;
+    float cpu_percent;
+  };
+  std::vector<Sample> samples;
+  std::vector<std::string> stale;
+  samples.reserve(cgroups_.size());
+
+  for (auto &[path, entry] : cgroups_) {
+    Sample s{&path, {}, entry.last, entry.has_last, 0};
+    if (!ReadCgroup(entry.dir_fd, &s.cur)) {
+      stale.push_back(path);
+      continue;
+    }
+    if (s.has_last && dt_us > 0) {
+      s.cpu_percent =
+          counter_delta(s.cur.usage_usec, s.last.usage_usec) / dt_us * 100.0;
+    }
+    entry.last = s.cur;
+    entry.has_last = true;
+    samples.push_back(s);
+  }
+
+  // 分别按 CPU 与内存选出 Top-N，两者取并集上报
+  size_t n = std::min(top_n_, samples.size());
+  std::vector<bool> selected(samples.size(), false);
+  std::vector<size_t> order(samples.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                    [&](size_t a, size_t b) {
+                      return samples[a].cpu_percent > samples[b].cpu_percent;
+                    });
+  for (size_t i = 0; i < n; ++i)
+    selected[order[i]] = true;
+
+  std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                    [&](size_t a, size_t b) {
+                      return samples[a].cur.memory_current >
+                             samples[b].cur.memory_current;
+                    });
+  for (size_t i = 0; i < n; ++i)
+    selected[order[i]] = true;
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    if (!selected[i]) {
+      continue;
+    }
+    const Sample &s = samples[i];
+    auto cgroup_msg = monitor_info->add_cgroup_info();
+    cgroup_msg->set_path(*s.path);
+    cgroup_msg->set_cpu_percent(s.cpu_percent);
+    cgroup_msg->set_memory_current(s.cur.memory_current / BToMB);
+    cgroup_msg->set_memory_anon(s.cur.memory_anon / BToMB);
+    cgroup_msg->set_memory_file(s.cur.memory_file / BToMB);
+    cgroup_msg->set_cpu_pressure_some(s.cur.cpu_some);
+    cgroup_msg->set_memory_pressure_some(s.cur.memory_some);
+    cgroup_msg->set_memory_pressure_full(s.cur.memory_full);
+    cgroup_msg->set_io_pressure_some(s.cur.io_some);
+    cgroup_msg->set_io_pressure_full(s.cur.io_full);
+
+    if (s.has_last && dt > 0) {
+      const CgroupStat &cur = s.cur;
+      const CgroupStat &last = s.last;
+      cgroup_msg->set_user_percent(
+          counter_delta(cur.user_usec, last.user_usec) / dt_us * 100.0);
+      cgroup_msg->set_system_percent(
+          counter_delta(cur.system_usec, last.system_usec) / dt_us * 100.0);
+      cgroup_msg->set_throttled_percent(
+          counter_delta(cur.throttled_usec, last.throttled_usec) / dt_us *
+          100.0);
+      cgroup_msg->set_nr_throttled(
+          counter_delta(cur.nr_throttled, last.nr_throttled));
+      cgroup_msg->set_read_bytes_per_sec(
+          counter_delta(cur.rbytes, last.rbytes) / dt);
+      cgroup_msg->set_write_bytes_per_sec(
+          counter_delta(cur.wbytes, last.wbytes) / dt);
+      cgroup_msg->set_read_iops(counter_delta(cur.rios, last.rios) / dt);
+      cgroup_msg->set_write_iops(counter_delta(cur.wios, last.wios) / dt);
+    }
+  }
+
+  // samples 中保存的是 cgroups_ 键的指针，上报完成后再清理已删除的 cgroup
+  for (const auto &path : stale) {
+    RemoveSubtree(path);
+  }
+}
+
+void CgroupMonitor::Stop() {
+  for (auto &[_, entry] : cgroups_) {
+    close(entry.dir_fd);
+  }
+  cgroups_.clear();
+  wd_map_.clear();
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+  if (root_fd_ >= 0) {
+    close(root_fd_);
+    root_fd_ = -1;
+  }
+}
+} // namespace yanhon
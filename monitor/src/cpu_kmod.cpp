@@ -0,0 +1,675 @@
+#include "monitor/cpu_kmod.hpp"
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+#include "cpu_monitor.skel.h"
+
+namespace yanhon {
+// 模块每个周期只切换一次数据区，连续失败说明读端被长时间抢占
+static constexpr int kMaxRetries = 16;
+
+static uint64_t align_up(uint64_t x, uint64_t a) { return (x + a - 1) / a * a; }
+
+/**
+ * @brief 按模块 cpu_monitor_alloc 的规则生成 BPF 与 procfs 模式的头部
+ * 只有 LOAD/STAT/SOFTIRQ 三个分段，不含共享分段
+ * @return 整个区域的大小
+ */
+static size_t build_layout(uint32_t nr_cpus, struct cpu_monitor_header *hdr) {
+  const struct {
+    uint32_t id;
+    uint32_t nr_rows;
+    uint32_t row_size;
+  } layout[] = {
+      {CPU_MONITOR_SECTION_LOAD, 1, sizeof(struct cpu_monitor_load)},
+      {CPU_MONITOR_SECTION_STAT, nr_cpus, sizeof(struct cpu_monitor_stat)},
+      {CPU_MONITOR_SECTION_SOFTIRQ, nr_cpus,
+       sizeof(struct cpu_monitor_softirq)},
+  };
+  memset(hdr, 0, sizeof(*hdr));
+  uint64_t area_size = 0;
+  for (const auto &l : layout) {
+    struct cpu_monitor_section &sec = hdr->sections[hdr->nr_sections++];
+    sec.id = l.id;
+    sec.nr_rows = l.nr_rows;
+    sec.row_size = l.row_size;
+    sec.offset = area_size;
+    area_size = align_up(area_size + static_cast<uint64_t>(l.nr_rows) *
+                                         l.row_size,
+                         CPU_MONITOR_ALIGN);
+  }
+  hdr->magic = CPU_MONITOR_MAGIC;
+  hdr->version = CPU_MONITOR_VERSION;
+  hdr->header_size = align_up(sizeof(*hdr), CPU_MONITOR_ALIGN);
+  hdr->nr_cpus = nr_cpus;
+  hdr->area_size = area_size;
+  return hdr->header_size + 2 * area_size;
+}
+
+// ring buffer 中的记录只用于唤醒，内容不需要处理
+static int ignore_event(void *, void *, size_t) { return 0; }
+
+// avenrun 的小数部分为 11 位（内核的 FSHIFT）
+static constexpr uint64_t kFixed1 = 1 << 11;
+
+// /proc/softirqs 各行名称与 cpu_monitor_softirq 字段的对应关系
+static const struct {
+  const char *name;
+  __u64 cpu_monitor_softirq::*field;
+} kSoftirqFields[] = {
+    {"HI", &cpu_monitor_softirq::hi},
+    {"TIMER", &cpu_monitor_softirq::timer},
+    {"NET_TX", &cpu_monitor_softirq::net_tx},
+    {"NET_RX", &cpu_monitor_softirq::net_rx},
+    {"BLOCK", &cpu_monitor_softirq::block},
+    {"IRQ_POLL", &cpu_monitor_softirq::irq_poll},
+    {"TASKLET", &cpu_monitor_softirq::tasklet},
+    {"SCHED", &cpu_monitor_softirq::sched},
+    {"HRTIMER", &cpu_monitor_softirq::hrtimer},
+    {"RCU", &cpu_monitor_softirq::rcu},
+};
+static constexpr size_t kNrSoftirqs =
+    sizeof(kSoftirqFields) / sizeof(kSoftirqFields[0]);
+
+static uint64_t monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief 从头读取整个 procfs 文件，缓冲区装不下时加倍后重读
+ * 缓冲区只增不减，稳态下不分配内存
+ * @return 读到的字节数，失败时返回 -1
+ */
+static ssize_t read_proc(int fd, std::vector<char> *buf) {
+  while (true) {
+    ssize_t n = pread(fd, buf->data(), buf->size(), 0);
+    if (n < 0 || static_cast<size_t>(n) < buf->size()) {
+      return n;
+    }
+    buf->resize(buf->size() * 2);
+  }
+}
+
+/** @brief 跳过空格后解析一个十进制数，遇到其他字符时返回 false */
+static bool parse_u64(const char **p, const char *end, uint64_t *v) {
+  const char *q = *p;
+  while (q < end && *q == ' ') {
+    ++q;
+  }
+  if (q == end || *q < '0' || *q > '9') {
+    *p = q;
+    return false;
+  }
+  uint64_t x = 0;
+  for (; q < end && *q >= '0' && *q <= '9'; ++q) {
+    x = x * 10 + (*q - '0');
+  }
+  *p = q;
+  *v = x;
+  return true;
+}
+
+static const char *next_line(const char *p, const char *end) {
+  auto *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+  return nl ? nl + 1 : end;
+}
+
+CpuKmod::CpuKmod(Source source) {
+  bool any = source == Source::kAuto;
+  if ((any || source == Source::kDevice) && OpenDevice()) {
+    source_ = Source::kDevice;
+    return;
+  }
+  if (any || source == Source::kEbpf) {
+    if (LoadBpf()) {
+      source_ = Source::kEbpf;
+      return;
+    }
+    std::cerr << "cpu_monitor BPF backend unavailable" << std::endl;
+  }
+  if ((any || source == Source::kProcfs) && OpenProc()) {
+    source_ = Source::kProcfs;
+  }
+}
+
+bool CpuKmod::OpenDevice() {
+  // 非阻塞：确认读取在没有新快照时立即返回
+  fd_ = open("/dev/" CPU_MONITOR_DEVICE, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd_ < 0) {
+    std::cerr << "Failed to open /dev/" CPU_MONITOR_DEVICE ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  // 先映射头部，由头部中的大小确定完整映射
+  struct cpu_monitor_header hdr;
+  void *head = mmap(nullptr, sizeof(hdr), PROT_READ, MAP_SHARED, fd_, 0);
+  if (head == MAP_FAILED) {
+    std::cerr << "mmap /dev/" CPU_MONITOR_DEVICE " failed: " << strerror(errno)
+              << std::endl;
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  memcpy(&hdr, head, sizeof(hdr));
+  munmap(head, sizeof(hdr));
+  if (hdr.magic != CPU_MONITOR_MAGIC || hdr.version != CPU_MONITOR_VERSION) {
+    // 模块与 agent 版本不一致时拒绝使用映射，不按错误的布局解析
+    std::cerr << "cpu_monitor layout mismatch: magic " << std::hex
+              << hdr.magic << std::dec << ", module version " << hdr.version
+              << ", agent expects " << CPU_MONITOR_VERSION
+              << "; load the cpu_monitor_kmod.ko built from this tree"
+              << std::endl;
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  // 共享分段（历史环）排在两个数据区之后，映射需要覆盖到最后一个分段
+  size_t size = hdr.header_size + 2 * hdr.area_size;
+  uint32_t n = std::min<uint32_t>(hdr.nr_sections, CPU_MONITOR_MAX_SECTIONS);
+  for (uint32_t i = 0; i < n; ++i) {
+    const struct cpu_monitor_section &sec = hdr.sections[i];
+    if (sec.flags & CPU_MONITOR_SECTION_F_SHARED) {
+      size = std::max<size_t>(
+          size, sec.offset + static_cast<uint64_t>(sec.nr_rows) * sec.row_size);
+    }
+  }
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    std::cerr << "mmap /dev/" CPU_MONITOR_DEVICE " failed: " << strerror(errno)
+              << std::endl;
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  map_ = addr;
+  map_size_ = size;
+  hdr_ = static_cast<const struct cpu_monitor_header *>(addr);
+  return true;
+}
+
+CpuKmod::~CpuKmod() {
+  if (map_) {
+    munmap(map_, map_size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  UnloadBpf();
+  for (int fd : {stat_fd_, loadavg_fd_, softirqs_fd_}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+/**
+ * @brief 加载 BPF 数据源：设置布局常量后加载，写入头部并映射，
+ * 最后运行 start_timer 发布第一次快照并启动定时器
+ */
+bool CpuKmod::LoadBpf() {
+  int ncpus = libbpf_num_possible_cpus();
+  if (ncpus <= 0) {
+    return false;
+  }
+  struct cpu_monitor_header hdr;
+  size_t size = build_layout(ncpus, &hdr);
+  skel_ = cpu_monitor_bpf__open();
+  if (!skel_) {
+    return false;
+  }
+  skel_->rodata->nr_cpus = ncpus;
+  skel_->rodata->header_size = hdr.header_size;
+  skel_->rodata->area_size = hdr.area_size;
+  skel_->rodata->load_off = hdr.sections[0].offset;
+  skel_->rodata->stat_off = hdr.sections[1].offset;
+  skel_->rodata->softirq_off = hdr.sections[2].offset;
+  bpf_map__set_value_size(skel_->maps.region, size);
+  bpf_map__set_max_entries(skel_->maps.softirq_acc, ncpus);
+  if (cpu_monitor_bpf__load(skel_) != 0) {
+    UnloadBpf();
+    return false;
+  }
+
+  // 头部在定时器启动前写入，之后 BPF 程序只改写 seq/active 等字段
+  int region_fd = bpf_map__fd(skel_->maps.region);
+  std::vector<char> init(size);
+  memcpy(init.data(), &hdr, sizeof(hdr));
+  __u32 zero = 0;
+  if (bpf_map_update_elem(region_fd, &zero, init.data(), BPF_ANY) != 0) {
+    UnloadBpf();
+    return false;
+  }
+  rb_ = ring_buffer__new(bpf_map__fd(skel_->maps.events), ignore_event,
+                         nullptr, nullptr);
+  void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, region_fd, 0);
+  if (!rb_ || addr == MAP_FAILED) {
+    std::cerr << (rb_ ? "mmap cpu_monitor BPF region failed: "
+                      : "cpu_monitor BPF ring buffer failed: ")
+              << strerror(errno) << std::endl;
+    if (addr != MAP_FAILED) {
+      munmap(addr, size);
+    }
+    UnloadBpf();
+    return false;
+  }
+  LIBBPF_OPTS(bpf_test_run_opts, opts);
+  int prog_fd = bpf_program__fd(skel_->progs.start_timer);
+  if (bpf_prog_test_run_opts(prog_fd, &opts) != 0 || opts.retval != 0) {
+    std::cerr << "Failed to start cpu_monitor BPF timer" << std::endl;
+    munmap(addr, size);
+    UnloadBpf();
+    return false;
+  }
+  map_ = addr;
+  map_size_ = size;
+  hdr_ = static_cast<const struct cpu_monitor_header *>(addr);
+  return true;
+}
+
+void CpuKmod::UnloadBpf() {
+  if (rb_) {
+    ring_buffer__free(rb_);
+    rb_ = nullptr;
+  }
+  if (skel_) {
+    cpu_monitor_bpf__destroy(skel_);
+    skel_ = nullptr;
+  }
+}
+
+bool CpuKmod::OpenProc() {
+  int ncpus = libbpf_num_possible_cpus();
+  long hz = sysconf(_SC_CLK_TCK);
+  if (ncpus <= 0 || hz <= 0) {
+    return false;
+  }
+  const struct {
+    const char *path;
+    int *fd;
+  } files[] = {
+      {"/proc/stat", &stat_fd_},
+      {"/proc/loadavg", &loadavg_fd_},
+      {"/proc/softirqs", &softirqs_fd_},
+  };
+  for (const auto &file : files) {
+    *file.fd = open(file.path, O_RDONLY | O_CLOEXEC);
+    if (*file.fd < 0) {
+      std::cerr << "Failed to open " << file.path << ": " << strerror(errno)
+                << std::endl;
+      return false;
+    }
+  }
+  build_layout(ncpus, &proc_hdr_);
+  ns_per_tick_ = 1000000000ULL / hz;
+  proc_buf_.resize(64 * 1024);
+  softirq_cpus_.reserve(ncpus);
+  softirq_last_.assign(ncpus * kNrSoftirqs, 0);
+  softirq_total_.assign(ncpus * kNrSoftirqs, 0);
+  hdr_ = &proc_hdr_;
+  return true;
+}
+
+bool CpuKmod::RefreshProc() {
+  uint64_t now = monotonic_ns();
+  // 同一轮采集中各监控器先后调用 Refresh，间隔很短时共用同一份快照
+  if (!snapshot_.empty() && now - timestamp_ns_ < CPU_MONITOR_INTERVAL_MIN_NS) {
+    return true;
+  }
+  snapshot_.resize(proc_hdr_.area_size);
+  char *area = snapshot_.data();
+  // 软中断行按 STAT 行判断 CPU 是否在线，必须在 /proc/stat 之后解析
+  if (!ParseLoadavg(area) || !ParseStat(area) || !ParseSoftirqs(area)) {
+    snapshot_.clear();
+    return false;
+  }
+  timestamp_ns_ = now;
+  ++tick_;
+  return true;
+}
+
+bool CpuKmod::ParseLoadavg(char *area) {
+  ssize_t n = read_proc(loadavg_fd_, &proc_buf_);
+  if (n < 0) {
+    std::cerr << "read /proc/loadavg failed: " << strerror(errno) << std::endl;
+    return false;
+  }
+  auto *load = reinterpret_cast<struct cpu_monitor_load *>(
+      area + proc_hdr_.sections[0].offset);
+  const char *p = proc_buf_.data();
+  const char *end = p + n;
+  for (__u64 *field :
+       {&load->load_avg_1, &load->load_avg_3, &load->load_avg_15}) {
+    uint64_t whole = 0;
+    uint64_t frac = 0;
+    if (!parse_u64(&p, end, &whole)) {
+      std::cerr << "Unexpected /proc/loadavg format" << std::endl;
+      return false;
+    }
+    if (p < end && *p == '.') {
+      ++p;
+      parse_u64(&p, end, &frac);
+    }
+    // /proc/loadavg 保留两位小数，四舍五入换算回 avenrun 的定点数
+    *field = ((whole * 100 + frac) * kFixed1 + 50) / 100;
+  }
+  return true;
+}
+
+bool CpuKmod::ParseStat(char *area) {
+  ssize_t n = read_proc(stat_fd_, &proc_buf_);
+  if (n < 0) {
+    std::cerr << "read /proc/stat failed: " << strerror(errno) << std::endl;
+    return false;
+  }
+  auto *stats = reinterpret_cast<struct cpu_monitor_stat *>(
+      area + proc_hdr_.sections[1].offset);
+  uint32_t nr_cpus = proc_hdr_.nr_cpus;
+  for (uint32_t cpu = 0; cpu < nr_cpus; ++cpu) {
+    stats[cpu].cpu_name[0] = '\0';
+  }
+  uint64_t now = monotonic_ns();
+  const char *p = proc_buf_.data();
+  const char *end = p + n;
+  // 只列出在线 CPU，cpuN 行紧跟在汇总的 cpu 行之后；单位为 USER_HZ
+  for (; end - p > 3 && memcmp(p, "cpu", 3) == 0; p = next_line(p, end)) {
+    const char *q = p + 3;
+    uint64_t cpu;
+    if (*q < '0' || *q > '9' || !parse_u64(&q, end, &cpu) || cpu >= nr_cpus) {
+      continue;
+    }
+    // 旧内核没有 steal/guest 列，缺少的按 0 处理
+    uint64_t v[10] = {};
+    for (uint64_t &x : v) {
+      if (!parse_u64(&q, end, &x)) {
+        break;
+      }
+      x *= ns_per_tick_;
+    }
+    struct cpu_monitor_stat *s = &stats[cpu];
+    s->user = v[0];
+    s->nice = v[1];
+    s->system = v[2];
+    s->idle = v[3];
+    s->io_wait = v[4];
+    s->irq = v[5];
+    s->soft_irq = v[6];
+    s->steal = v[7];
+    s->guest = v[8];
+    s->guest_nice = v[9];
+    s->total = s->user + s->nice + s->system + s->idle + s->io_wait + s->irq +
+               s->soft_irq + s->steal + s->guest + s->guest_nice;
+    s->timestamp = now;
+    snprintf(s->cpu_name, sizeof(s->cpu_name), "CPU%u",
+             static_cast<uint32_t>(cpu));
+  }
+  return true;
+}
+
+bool CpuKmod::ParseSoftirqs(char *area) {
+  ssize_t n = read_proc(softirqs_fd_, &proc_buf_);
+  if (n < 0) {
+    std::cerr << "read /proc/softirqs failed: " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  uint32_t nr_cpus = proc_hdr_.nr_cpus;
+  auto *rows = reinterpret_cast<struct cpu_monitor_softirq *>(
+      area + proc_hdr_.sections[2].offset);
+  const auto *stats = reinterpret_cast<const struct cpu_monitor_stat *>(
+      area + proc_hdr_.sections[1].offset);
+  for (uint32_t cpu = 0; cpu < nr_cpus; ++cpu) {
+    if (stats[cpu].cpu_name[0] == '\0') {
+      rows[cpu].cpu_name[0] = '\0';
+    } else {
+      snprintf(rows[cpu].cpu_name, sizeof(rows[cpu].cpu_name), "cpu%u", cpu);
+    }
+  }
+
+  // 表头为每个可能的 CPU 一列 "CPUn"，CPU 编号可能不连续
+  const char *p = proc_buf_.data();
+  const char *end = p + n;
+  const char *eol = next_line(p, end);
+  softirq_cpus_.clear();
+  for (const char *q = p;;) {
+    while (q < eol && *q == ' ') {
+      ++q;
+    }
+    uint64_t cpu;
+    if (eol - q < 3 || memcmp(q, "CPU", 3) != 0) {
+      break;
+    }
+    q += 3;
+    if (!parse_u64(&q, eol, &cpu)) {
+      break;
+    }
+    softirq_cpus_.push_back(cpu);
+  }
+
+  // 计数为 32 位，与模块相同按增量累加扩展为 64 位
+  for (p = eol; p < end; p = eol) {
+    eol = next_line(p, end);
+    const char *q = p;
+    while (q < eol && *q == ' ') {
+      ++q;
+    }
+    auto *colon = static_cast<const char *>(memchr(q, ':', eol - q));
+    if (!colon) {
+      continue;
+    }
+    size_t nr = 0;
+    size_t len = colon - q;
+    while (nr < kNrSoftirqs && (strlen(kSoftirqFields[nr].name) != len ||
+                                memcmp(q, kSoftirqFields[nr].name, len) != 0)) {
+      ++nr;
+    }
+    if (nr == kNrSoftirqs) {
+      continue;
+    }
+    q = colon + 1;
+    for (uint32_t cpu : softirq_cpus_) {
+      uint64_t v;
+      if (!parse_u64(&q, eol, &v)) {
+        break;
+      }
+      if (cpu >= nr_cpus || rows[cpu].cpu_name[0] == '\0') {
+        continue;
+      }
+      size_t i = cpu * kNrSoftirqs + nr;
+      softirq_total_[i] += static_cast<uint32_t>(v - softirq_last_[i]);
+      softirq_last_[i] = v;
+      rows[cpu].*kSoftirqFields[nr].field = softirq_total_[i];
+    }
+  }
+  return true;
+}
+
+int CpuKmod::fd() const { return rb_ ? ring_buffer__epoll_fd(rb_) : fd_; }
+
+bool CpuKmod::WaitFresh(std::chrono::milliseconds timeout) {
+  if (!map_ || fd() < 0) {
+    return false;
+  }
+  // 上次 Refresh 确认之后发布的快照会让 fd 一直可读，先清除，只等待
+  // 调用之后的下一次发布；本地副本仍由 Refresh 按 seq 判断是否需要更新
+  Acknowledge();
+  struct pollfd pfd = {fd(), POLLIN, 0};
+  int ret = poll(&pfd, 1, timeout.count());
+  return ret > 0 && (pfd.revents & POLLIN);
+}
+
+std::chrono::nanoseconds
+CpuKmod::SetInterval(std::chrono::nanoseconds interval) {
+  if (!map_) {
+    return std::chrono::nanoseconds(0);
+  }
+  __u64 ns = interval.count() > 0 ? interval.count() : 0;
+  if (skel_) {
+    ns = std::clamp<__u64>(ns, CPU_MONITOR_INTERVAL_MIN_NS,
+                           CPU_MONITOR_INTERVAL_MAX_NS);
+    __atomic_store_n(&skel_->data->interval_ns, ns, __ATOMIC_RELAXED);
+    return std::chrono::nanoseconds(ns);
+  }
+  if (ioctl(fd_, CPU_MONITOR_IOC_SET_INTERVAL, &ns) < 0) {
+    std::cerr << "Failed to set cpu_monitor interval: " << strerror(errno)
+              << std::endl;
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::nanoseconds(ns);
+}
+
+const struct cpu_monitor_burst *CpuKmod::NextBurst(uint32_t *nr_rows) {
+  if (burst_disabled_) {
+    return nullptr;
+  }
+  const struct cpu_monitor_section *sec = FindSection(
+      CPU_MONITOR_SECTION_BURST, sizeof(struct cpu_monitor_burst), true);
+  uint32_t nr_cpus = this->nr_cpus();
+  if (!sec || nr_cpus == 0 || sec->nr_rows != 2 * nr_cpus) {
+    burst_disabled_ = true;
+    return nullptr;
+  }
+  __u64 gen;
+  if (ioctl(fd_, CPU_MONITOR_IOC_BURST_NEXT, &gen) < 0) {
+    std::cerr << "cpu_monitor burst statistics disabled: " << strerror(errno)
+              << (errno == EPERM ? " (BURST_NEXT requires CAP_SYS_ADMIN)" : "")
+              << std::endl;
+    burst_disabled_ = true;
+    return nullptr;
+  }
+  *nr_rows = nr_cpus;
+  auto *rows = reinterpret_cast<const struct cpu_monitor_burst *>(
+      static_cast<const char *>(map_) + sec->offset);
+  return rows + (gen & 1) * nr_cpus;
+}
+
+void CpuKmod::Acknowledge() {
+  if (rb_) {
+    ring_buffer__consume(rb_);
+    return;
+  }
+  // 读出的 seq 只用于清除可读状态，没有新快照时返回 EAGAIN
+  uint32_t seq;
+  if (read(fd_, &seq, sizeof(seq)) < 0 && errno != EAGAIN) {
+    std::cerr << "read /dev/" CPU_MONITOR_DEVICE " failed: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+bool CpuKmod::Refresh() {
+  if (source_ == Source::kProcfs) {
+    return RefreshProc();
+  }
+  if (!map_) {
+    return false;
+  }
+  const char *areas = static_cast<const char *>(map_) + hdr_->header_size;
+  size_t area_size = hdr_->area_size;
+  for (int i = 0; i < kMaxRetries; ++i) {
+    uint32_t seq = __atomic_load_n(&hdr_->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      continue;
+    }
+    if (!snapshot_.empty() && seq == snapshot_seq_) {
+      return true;
+    }
+    uint32_t active = __atomic_load_n(&hdr_->active, __ATOMIC_RELAXED) & 1;
+    uint64_t timestamp = __atomic_load_n(&hdr_->timestamp_ns,
+                                         __ATOMIC_RELAXED);
+    uint64_t interval = __atomic_load_n(&hdr_->interval_ns, __ATOMIC_RELAXED);
+    uint64_t tick = __atomic_load_n(&hdr_->tick, __ATOMIC_RELAXED);
+    // 奇数不会与任何稳定的 seq 相等，复制失败时本地副本不会被误用
+    snapshot_seq_ = 1;
+    snapshot_.resize(area_size);
+    memcpy(snapshot_.data(), areas + active * area_size, area_size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (__atomic_load_n(&hdr_->seq, __ATOMIC_RELAXED) == seq) {
+      snapshot_seq_ = seq;
+      timestamp_ns_ = timestamp;
+      interval_ns_ = interval;
+      tick_ = tick;
+      Acknowledge();
+      return true;
+    }
+  }
+  // 丢弃可能撕裂的副本，下次重新复制
+  snapshot_.clear();
+  return false;
+}
+
+uint32_t CpuKmod::HistoryDepth() const {
+  const struct cpu_monitor_section *sec =
+      FindSection(CPU_MONITOR_SECTION_STAT_HISTORY, 0, true);
+  return sec ? sec->nr_rows : 0;
+}
+
+const struct cpu_monitor_history_slot *
+CpuKmod::ReadHistory(uint64_t tick, std::vector<char> *buf) const {
+  const struct cpu_monitor_section *sec =
+      FindSection(CPU_MONITOR_SECTION_STAT_HISTORY, 0, true);
+  if (!sec || sec->nr_rows == 0 || tick == 0) {
+    return nullptr;
+  }
+  const char *row = static_cast<const char *>(map_) + sec->offset +
+                    tick % sec->nr_rows * sec->row_size;
+  auto *slot = reinterpret_cast<const struct cpu_monitor_history_slot *>(row);
+  if (__atomic_load_n(&slot->tick, __ATOMIC_ACQUIRE) != tick) {
+    return nullptr;
+  }
+  buf->resize(sec->row_size);
+  memcpy(buf->data(), row, sec->row_size);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (__atomic_load_n(&slot->tick, __ATOMIC_RELAXED) != tick) {
+    return nullptr;
+  }
+  auto *copy =
+      reinterpret_cast<const struct cpu_monitor_history_slot *>(buf->data());
+  // nr_cpus 来自共享内存，确认样本没有越过行尾
+  if (sizeof(*copy) + static_cast<uint64_t>(copy->nr_cpus) *
+                          sizeof(struct cpu_monitor_sample) >
+      sec->row_size) {
+    return nullptr;
+  }
+  return copy;
+}
+
+const struct cpu_monitor_section *
+CpuKmod::FindSection(uint32_t id, size_t row_size, bool shared) const {
+  if (!hdr_) {
+    return nullptr;
+  }
+  uint32_t n = std::min<uint32_t>(hdr_->nr_sections, CPU_MONITOR_MAX_SECTIONS);
+  for (uint32_t i = 0; i < n; ++i) {
+    const struct cpu_monitor_section &sec = hdr_->sections[i];
+    if (sec.id != id) {
+      continue;
+    }
+    // 普通分段相对数据区，共享分段相对映射起始处；row_size 为 0 时不检查
+    uint64_t limit = shared ? map_size_ : hdr_->area_size;
+    bool is_shared = sec.flags & CPU_MONITOR_SECTION_F_SHARED;
+    if (is_shared != shared ||
+        (row_size != 0 && sec.row_size != row_size) ||
+        sec.offset + static_cast<uint64_t>(sec.nr_rows) * sec.row_size >
+            limit) {
+      std::cerr << "cpu_monitor section " << id << " has unexpected layout"
+                << std::endl;
+      return nullptr;
+    }
+    return &sec;
+  }
+  return nullptr;
+}
+} // namespace yanhon
@@ -1,7 +1,4 @@
 #include "monitor/cpu_load_monitor.hpp"
-#include <fcntl.h>
-#include <string.h>
-#include <sys/mman.h>
 
 #ifndef FIXED_1
 #define FSHIFT 11
@@ -9,28 +6,23 @@
 #endif
 
 namespace yanhon {
+CpuLoadMonitor::CpuLoadMonitor(std::shared_ptr<CpuKmod> kmod)
+    : kmod_(kmod ? std::move(kmod) : std::make_shared<CpuKmod>()) {}
+
 void CpuLoadMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
-  int fd = open("/dev/cpu_load_monitor", O_RDONLY);
-  if (fd < 0) {
+  if (!kmod_->Refresh()) {
     return;
   }
-
-  size_t data_size = sizeof(struct cpu_load);
-  void *addr = mmap(nullptr, data_size, PROT_READ, MAP_SHARED, fd, 0);
-  if (addr == MAP_FAILED) {
-    close(fd);
+  uint32_t rows = 0;
+  auto *info =
+      kmod_->Rows<struct cpu_monitor_load>(CPU_MONITOR_SECTION_LOAD, &rows);
+  if (!info || rows == 0) {
     return;
   }
 
-  struct cpu_load info;
-  memcpy(&info, addr, data_size);
-
   auto cpu_load_msg = monitor_info->mutable_cpu_load();
-  cpu_load_msg->set_load_avg_1((float)info.load_avg_1 / FIXED_1);
-  cpu_load_msg->set_load_avg_3((float)info.load_avg_3 / FIXED_1);
-  cpu_load_msg->set_load_avg_15((float)info.load_avg_15 / FIXED_1);
-
-  munmap(addr, data_size);
-  close(fd);
+  cpu_load_msg->set_load_avg_1((float)info->load_avg_1 / FIXED_1);
+  cpu_load_msg->set_load_avg_3((float)info->load_avg_3 / FIXED_1);
+  cpu_load_msg->set_load_avg_15((float)info->load_avg_15 / FIXED_1);
 }
 } // namespace yanhon
@@ -1,42 +1,51 @@
 #include "monitor/cpu_softirq_monitor.hpp"
-#include <fcntl.h>
-#include <sys/mman.h>
 
 namespace yanhon {
+CpuSoftIrqMonitor::CpuSoftIrqMonitor(std::shared_ptr<CpuKmod> kmod)
+    : kmod_(kmod ? std::move(kmod) : std::make_shared<CpuKmod>()) {}
+
 void CpuSoftIrqMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
-  int fd = open("/dev/cpu_softirq_monitor", O_RDONLY);
-  if (fd < 0)
+  if (!kmod_->Refresh()) {
     return;
-
-  size_t stat_count = 128; // 假设最多128个CPU
-  size_t stat_size = sizeof(struct softirq_stat) * stat_count;
-  void *addr = mmap(nullptr, stat_size, PROT_READ, MAP_SHARED, fd, 0);
-  if (addr == MAP_FAILED) {
-    close(fd);
+  }
+  uint32_t stat_count = 0;
+  auto *stats = kmod_->Rows<struct cpu_monitor_softirq>(
+      CPU_MONITOR_SECTION_SOFTIRQ, &stat_count);
+  if (!stats) {
     return;
   }
 
-  struct softirq_stat *stats = static_cast<struct softirq_stat *>(addr);
-
-  for (size_t i = 0; i < stat_count; ++i) {
-    if (stats[i].cpu_name[0] == '\0') {
-      break;
+  uint64_t now = kmod_->timestamp_ns();
+  if (now == last_timestamp_ns_) {
+    // 模块尚未发布新快照
+    return;
+  }
+  double dt = (now - last_timestamp_ns_) / 1e9;
+  bool has_last = last_timestamp_ns_ != 0 && last_.size() == stat_count;
+  for (size_t i = 0; has_last && i < stat_count; ++i) {
+    const struct cpu_monitor_softirq &cur = stats[i];
+    const struct cpu_monitor_softirq &old = last_[i];
+    // 离线 CPU 的行名称为空，刚上线的 CPU 下次才有基准
+    if (cur.cpu_name[0] == '\0' || old.cpu_name[0] == '\0') {
+      continue;
     }
+    auto rate = [dt](uint64_t c, uint64_t o) {
+      return c >= o ? (c - o) / dt : 0;
+    };
     auto one_softirq_msg = monitor_info->add_soft_irq();
-    one_softirq_msg->set_cpu(stats[i].cpu_name);
-    one_softirq_msg->set_hi(stats[i].hi);
-    one_softirq_msg->set_timer(stats[i].timer);
-    one_softirq_msg->set_net_tx(stats[i].net_tx);
-    one_softirq_msg->set_net_rx(stats[i].net_rx);
-    one_softirq_msg->set_block(stats[i].block);
-    one_softirq_msg->set_irq_poll(stats[i].irq_poll);
-    one_softirq_msg->set_tasklet(stats[i].tasklet);
-    one_softirq_msg->set_sched(stats[i].sched);
-    one_softirq_msg->set_hrtimer(stats[i].hrtimer);
-    one_softirq_msg->set_rcu(stats[i].rcu);
+    one_softirq_msg->set_cpu(cur.cpu_name);
+    one_softirq_msg->set_hi(rate(cur.hi, old.hi));
+    one_softirq_msg->set_timer(rate(cur.timer, old.timer));
+    one_softirq_msg->set_net_tx(rate(cur.net_tx, old.net_tx));
+    one_softirq_msg->set_net_rx(rate(cur.net_rx, old.net_rx));
+    one_softirq_msg->set_block(rate(cur.block, old.block));
+    one_softirq_msg->set_irq_poll(rate(cur.irq_poll, old.irq_poll));
+    one_softirq_msg->set_tasklet(rate(cur.tasklet, old.tasklet));
+    one_softirq_msg->set_sched(rate(cur.sched, old.sched));
+    one_softirq_msg->set_hrtimer(rate(cur.hrtimer, old.hrtimer));
+    one_softirq_msg->set_rcu(rate(cur.rcu, old.rcu));
   }
-
-  munmap(addr, stat_size);
-  close(fd);
+  last_.assign(stats, stats + stat_count);
+  last_timestamp_ns_ = now;
 }
-} // namespace yanhon
\ No newline at end of file
+} // namespace yanhon
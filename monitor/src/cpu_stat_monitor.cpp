@@ -1,112 +1,313 @@
 #include "monitor/cpu_stat_monitor.hpp"
+#include <algorithm>
+#include <dirent.h>
 #include <fcntl.h>
-#include <sys/mman.h>
+#include <stdlib.h>
+#include <map>
+#include <utility>
 
 namespace yanhon {
-void CpuStatMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
-  int fd = open("/dev/cpu_stat_monitor", O_RDONLY);
+/**
+ * @brief 两次采样之间各类 CPU 时间的增量（纳秒）
+ */
+struct CpuTimes {
+  u64 user;
+  u64 system;
+  u64 nice;
+  u64 idle;
+  u64 io_wait;
+  u64 irq;
+  u64 soft_irq;
+  u64 steal;
+
+  // user字段不包含nice时间，两者都是用户态时间但分开统计
+  u64 busy() const { return user + system + nice + irq + soft_irq + steal; }
+  u64 total() const { return busy() + idle + io_wait; }
+};
+
+/**
+ * @brief 拓扑分组的累加器，组内各类 CPU 时间的增量求和后再计算百分比
+ */
+struct TopoAccum {
+  CpuTimes sum{};
+  uint32_t cpus = 0;
+  float max_percent = 0;
+  float min_percent = 100;
+};
+
+static u64 sub(u64 cur, u64 old) { return cur > old ? cur - old : 0; }
+
+static CpuTimes diff(const struct cpu_monitor_stat &cur,
+                     const struct cpu_monitor_stat &old) {
+  CpuTimes d;
+  d.user = sub(cur.user, old.user);
+  d.system = sub(cur.system, old.system);
+  d.nice = sub(cur.nice, old.nice);
+  d.idle = sub(cur.idle, old.idle);
+  d.io_wait = sub(cur.io_wait, old.io_wait);
+  d.irq = sub(cur.irq, old.irq);
+  d.soft_irq = sub(cur.soft_irq, old.soft_irq);
+  d.steal = sub(cur.steal, old.steal);
+  return d;
+}
+
+static float busy_percent(const CpuTimes &d) {
+  u64 total = d.total();
+  return total > 0 ? d.busy() * 100.0 / total : 0;
+}
+
+/**
+ * @brief 设置百分比字段，CpuStat 与 CpuTopoStat 字段名相同；
+ * 总时间为 0 时保持默认值 0，避免除以零
+ */
+template <typename Msg> static void set_percent(Msg *msg, const CpuTimes &d) {
+  u64 total = d.total();
+  if (total == 0) {
+    return;
+  }
+  double scale = 100.0 / total;
+  msg->set_cpu_percent(d.busy() * scale);
+  msg->set_usr_percent(d.user * scale);
+  msg->set_system_percent(d.system * scale);
+  msg->set_idle_percent(d.idle * scale);
+  msg->set_io_wait_percent(d.io_wait * scale);
+  msg->set_irq_percent(d.irq * scale);
+  msg->set_soft_irq_percent(d.soft_irq * scale);
+}
+
+static void accumulate(TopoAccum *acc, const CpuTimes &d, float percent) {
+  acc->sum.user += d.user;
+  acc->sum.system += d.system;
+  acc->sum.nice += d.nice;
+  acc->sum.idle += d.idle;
+  acc->sum.io_wait += d.io_wait;
+  acc->sum.irq += d.irq;
+  acc->sum.soft_irq += d.soft_irq;
+  acc->sum.steal += d.steal;
+  acc->cpus++;
+  acc->max_percent = std::max(acc->max_percent, percent);
+  acc->min_percent = std::min(acc->min_percent, percent);
+}
+
+/**
+ * @brief 读取 sysfs 中的单个整数，失败返回 -1
+ */
+static long read_long(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
   if (fd < 0) {
-    std::cerr << "Failed to open /dev/cpu_stat_monitor: " << strerror(errno)
+    return -1;
+  }
+  char buf[32];
+  ssize_t n = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (n <= 0) {
+    return -1;
+  }
+  buf[n] = '\0';
+  return strtol(buf, nullptr, 10);
+}
+
+CpuStatMonitor::CpuStatMonitor(std::shared_ptr<CpuKmod> kmod, bool emit_per_cpu,
+                               bool emit_per_core, bool burst)
+    : kmod_(kmod ? std::move(kmod) : std::make_shared<CpuKmod>()),
+      emit_per_cpu_(emit_per_cpu), emit_per_core_(emit_per_core),
+      burst_(burst) {}
+
+/**
+ * @brief 建立 CPU 编号 -> socket/物理核分组下标的映射，在线 CPU 数变化
+ * （包括首次采集）时重新建立；离线 CPU 没有 topology 目录，不计入聚合
+ */
+void CpuStatMonitor::LoadTopology() {
+  cpu_topo_.clear();
+  sockets_.clear();
+  cores_.clear();
+  const std::string root = "/sys/devices/system/cpu/";
+  DIR *dir = opendir(root.c_str());
+  if (!dir) {
+    std::cerr << "Failed to open " << root << ": " << strerror(errno)
               << std::endl;
     return;
   }
+  std::map<long, int32_t> socket_index;
+  std::map<std::pair<long, long>, int32_t> core_index;
+  while (struct dirent *de = readdir(dir)) {
+    if (strncmp(de->d_name, "cpu", 3) != 0 || de->d_name[3] < '0' ||
+        de->d_name[3] > '9') {
+      continue;
+    }
+    long cpu = strtol(de->d_name + 3, nullptr, 10);
+    std::string topo = root + de->d_name + "/topology/";
+    long socket_id = read_long(topo + "physical_package_id");
+    long core_id = read_long(topo + "core_id");
+    if (socket_id < 0 || core_id < 0) {
+      continue;
+    }
+    if (cpu_topo_.size() <= static_cast<size_t>(cpu)) {
+      cpu_topo_.resize(cpu + 1);
+    }
+    socket_index.emplace(socket_id, 0);
+    core_index.emplace(std::make_pair(socket_id, core_id), 0);
+    // 先暂存 id，分组编号确定后再换成下标
+    cpu_topo_[cpu].socket = socket_id;
+    cpu_topo_[cpu].core = core_id;
+  }
+  closedir(dir);
 
-  size_t stat_count = sysconf(_SC_NPROCESSORS_ONLN);
-  // std::cout << "DEBUG: CPU count = " << stat_count << std::endl;
-  size_t stat_size = sizeof(struct cpu_stat) * stat_count;
-  void *addr = mmap(nullptr, stat_size, PROT_READ, MAP_SHARED, fd, 0);
-  if (addr == MAP_FAILED) {
-    std::cerr << "mmap failed: " << strerror(errno) << std::endl;
-    close(fd);
+  // std::map 按 id 有序，分组按 socket、core 编号顺序输出
+  for (auto &[socket_id, index] : socket_index) {
+    index = sockets_.size();
+    sockets_.push_back({static_cast<uint32_t>(socket_id), -1,
+                        "socket" + std::to_string(socket_id)});
+  }
+  for (auto &[key, index] : core_index) {
+    index = cores_.size();
+    cores_.push_back({static_cast<uint32_t>(key.first),
+                      static_cast<int32_t>(key.second),
+                      "socket" + std::to_string(key.first) + "-core" +
+                          std::to_string(key.second)});
+  }
+  for (auto &topo : cpu_topo_) {
+    if (topo.socket < 0) {
+      continue;
+    }
+    long socket_id = topo.socket;
+    topo.socket = socket_index[socket_id];
+    topo.core = core_index[{socket_id, topo.core}];
+  }
+}
+
+/**
+ * @brief 遍历上次采集之后写入历史环的各项，逐 CPU 统计相邻两项之间的
+ * 使用率范围；间隔过长被覆盖或正在写入的项会打断相邻关系，从下一项重新
+ * 开始计算
+ */
+void CpuStatMonitor::ScanHistory() {
+  tick_range_.clear();
+  uint64_t tick = kmod_->tick();
+  uint32_t depth = kmod_->HistoryDepth();
+  if (depth == 0 || tick <= last_tick_) {
     return;
   }
+  uint64_t first = last_tick_ + 1;
+  if (last_tick_ == 0 || tick - last_tick_ > depth) {
+    // 首次采集或中间的项已被覆盖，只能从环中最旧的一项开始
+    first = tick > depth ? tick - depth + 1 : 1;
+    last_samples_.clear();
+  }
+  for (uint64_t t = first; t <= tick; ++t) {
+    auto *slot = kmod_->ReadHistory(t, &history_buf_);
+    if (!slot) {
+      last_samples_.clear();
+      continue;
+    }
+    if (last_samples_.size() == slot->nr_cpus) {
+      tick_range_.resize(slot->nr_cpus);
+      for (uint32_t cpu = 0; cpu < slot->nr_cpus; ++cpu) {
+        const struct cpu_monitor_sample &cur = slot->samples[cpu];
+        const struct cpu_monitor_sample &old = last_samples_[cpu];
+        // 任一端离线时 total 为 0
+        if (old.total == 0 || cur.total <= old.total) {
+          continue;
+        }
+        float percent =
+            sub(cur.busy, old.busy) * 100.0 / (cur.total - old.total);
+        TickRange &range = tick_range_[cpu];
+        range.max_percent = std::max(range.max_percent, percent);
+        range.min_percent = std::min(range.min_percent, percent);
+        range.ticks++;
+      }
+    }
+    last_samples_.assign(slot->samples, slot->samples + slot->nr_cpus);
+  }
+  last_tick_ = tick;
+}
 
-  struct cpu_stat *stats = static_cast<struct cpu_stat *>(addr);
+void CpuStatMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (!kmod_->Refresh()) {
+    return;
+  }
+  ScanHistory();
+  // 每次采集结束一代突发统计，覆盖两次采集之间的全部窗口
+  uint32_t burst_count = 0;
+  auto *burst = burst_ ? kmod_->NextBurst(&burst_count) : nullptr;
+  uint32_t stat_count = 0;
+  auto *stats = kmod_->Rows<struct cpu_monitor_stat>(CPU_MONITOR_SECTION_STAT,
+                                                     &stat_count);
+  if (!stats) {
+    return;
+  }
+  // 行数为模块的 nr_cpu_ids，离线 CPU 的行名称为空
+  uint32_t online = 0;
+  for (size_t i = 0; i < stat_count; ++i) {
+    online += stats[i].cpu_name[0] != '\0';
+  }
+  if (online != topo_online_) {
+    LoadTopology();
+    topo_online_ = online;
+  }
+  std::vector<TopoAccum> socket_acc(sockets_.size());
+  std::vector<TopoAccum> core_acc(emit_per_core_ ? cores_.size() : 0);
 
-  for (int i = 0; i < stat_count; ++i) {
+  for (size_t i = 0; i < stat_count; ++i) {
     if (stats[i].cpu_name[0] == '\0') {
-      break;
+      continue;
     }
+    // 第一次采集数据，无法计算百分比，全部保持为0
     auto it = cpu_stat_map_.find(stats[i].cpu_name);
-    auto cpu_stat_msg = monitor_info->add_cpu_stat();
-
-    if (it != cpu_stat_map_.end()) {
-      struct cpu_stat old = it->second;
-      // user字段不包含nice时间，两者都是用户态时间但分开统计
-      float new_cpu_total_time =
-          stats[i].user + stats[i].system + stats[i].idle + stats[i].nice +
-          stats[i].io_wait + stats[i].irq + stats[i].soft_irq + stats[i].steal;
-      float old_cpu_total_time = old.user + old.system + old.idle + old.nice +
-                                 old.io_wait + old.irq + old.soft_irq +
-                                 old.steal;
-      float new_cpu_busy_time = stats[i].user + stats[i].system +
-                                stats[i].nice + stats[i].irq +
-                                stats[i].soft_irq + stats[i].steal;
-      float old_cpu_busy_time =
-          old.user + old.system + old.nice + old.irq + old.soft_irq + old.steal;
-      if (new_cpu_total_time - old_cpu_total_time > 0) {
-        float cpu_percent = (new_cpu_busy_time - old_cpu_busy_time) /
-                            (new_cpu_total_time - old_cpu_total_time) * 100.00;
-        float cpu_user_percent = (stats[i].user - old.user) /
-                                 (new_cpu_total_time - old_cpu_total_time) *
-                                 100.00;
-        float cpu_system_percent = (stats[i].system - old.system) /
-                                   (new_cpu_total_time - old_cpu_total_time) *
-                                   100.00;
-        float cpu_nice_percent = (stats[i].nice - old.nice) /
-                                 (new_cpu_total_time - old_cpu_total_time) *
-                                 100.00;
-        float cpu_idle_percent = (stats[i].idle - old.idle) /
-                                 (new_cpu_total_time - old_cpu_total_time) *
-                                 100.00;
-        float cpu_io_wait_percent = (stats[i].io_wait - old.io_wait) /
-                                    (new_cpu_total_time - old_cpu_total_time) *
-                                    100.00;
-        float cpu_irq_percent = (stats[i].irq - old.irq) /
-                                (new_cpu_total_time - old_cpu_total_time) *
-                                100.00;
-        float cpu_soft_irq_percent = (stats[i].soft_irq - old.soft_irq) /
-                                     (new_cpu_total_time - old_cpu_total_time) *
-                                     100.00;
-        cpu_stat_msg->set_cpu_name(stats[i].cpu_name);
-        cpu_stat_msg->set_cpu_percent(cpu_percent);
-        cpu_stat_msg->set_usr_percent(cpu_user_percent);
-        cpu_stat_msg->set_system_percent(cpu_system_percent);
-        cpu_stat_msg->set_nice_percent(cpu_nice_percent);
-        cpu_stat_msg->set_idle_percent(cpu_idle_percent);
-        cpu_stat_msg->set_io_wait_percent(cpu_io_wait_percent);
-        cpu_stat_msg->set_irq_percent(cpu_irq_percent);
-        cpu_stat_msg->set_soft_irq_percent(cpu_soft_irq_percent);
-
-      } else {
-        // 避免除以零的情况，设置为0
-        cpu_stat_msg->set_cpu_name(stats[i].cpu_name);
-        cpu_stat_msg->set_cpu_percent(0.0);
-        cpu_stat_msg->set_usr_percent(0.0);
-        cpu_stat_msg->set_system_percent(0.0);
-        cpu_stat_msg->set_nice_percent(0.0);
-        cpu_stat_msg->set_idle_percent(0.0);
-        cpu_stat_msg->set_io_wait_percent(0.0);
-        cpu_stat_msg->set_irq_percent(0.0);
-        cpu_stat_msg->set_soft_irq_percent(0.0);
-      }
+    bool has_delta = it != cpu_stat_map_.end();
+    CpuTimes delta{};
+    if (has_delta) {
+      delta = diff(stats[i], it->second);
+    }
 
-    } else {
-      // 第一次采集数据，无法计算百分比，全部设置为0
+    if (emit_per_cpu_) {
+      auto cpu_stat_msg = monitor_info->add_cpu_stat();
       cpu_stat_msg->set_cpu_name(stats[i].cpu_name);
-      cpu_stat_msg->set_cpu_percent(0.0);
-      cpu_stat_msg->set_usr_percent(0.0);
-      cpu_stat_msg->set_system_percent(0.0);
-      cpu_stat_msg->set_nice_percent(0.0);
-      cpu_stat_msg->set_idle_percent(0.0);
-      cpu_stat_msg->set_io_wait_percent(0.0);
-      cpu_stat_msg->set_irq_percent(0.0);
-      cpu_stat_msg->set_soft_irq_percent(0.0);
+      set_percent(cpu_stat_msg, delta);
+      cpu_stat_msg->set_nice_percent(
+          delta.total() > 0 ? delta.nice * 100.0 / delta.total() : 0);
+      if (i < tick_range_.size() && tick_range_[i].ticks > 0) {
+        cpu_stat_msg->set_tick_percent_max(tick_range_[i].max_percent);
+        cpu_stat_msg->set_tick_percent_min(tick_range_[i].min_percent);
+        cpu_stat_msg->set_tick_count(tick_range_[i].ticks);
+      }
+      if (burst && i < burst_count && burst[i].samples > 0) {
+        cpu_stat_msg->set_cpu_percent_max(burst[i].max_bp / 100.0);
+        cpu_stat_msg->set_cpu_percent_min(burst[i].min_bp / 100.0);
+      }
+    }
+
+    if (has_delta && i < cpu_topo_.size() && cpu_topo_[i].socket >= 0) {
+      float percent = busy_percent(delta);
+      accumulate(&socket_acc[cpu_topo_[i].socket], delta, percent);
+      if (emit_per_core_) {
+        accumulate(&core_acc[cpu_topo_[i].core], delta, percent);
+      }
     }
     cpu_stat_map_[stats[i].cpu_name] = stats[i];
   }
-  munmap(addr, stat_size);
-  close(fd);
+
+  auto emit_groups = [](const std::vector<TopoGroup> &groups,
+                        const std::vector<TopoAccum> &accs, auto add_msg) {
+    for (size_t g = 0; g < accs.size(); ++g) {
+      const TopoAccum &acc = accs[g];
+      if (acc.cpus == 0) {
+        continue;
+      }
+      auto msg = add_msg();
+      msg->set_name(groups[g].name);
+      msg->set_socket_id(groups[g].socket_id);
+      msg->set_core_id(groups[g].core_id);
+      msg->set_cpu_count(acc.cpus);
+      set_percent(msg, acc.sum);
+      msg->set_max_cpu_percent(acc.max_percent);
+      msg->set_min_cpu_percent(acc.min_percent);
+    }
+  };
+  emit_groups(sockets_, socket_acc,
+              [&] { return monitor_info->add_cpu_socket_stat(); });
+  emit_groups(cores_, core_acc,
+              [&] { return monitor_info->add_cpu_core_stat(); });
 }
 
-} // namespace yanhon
\ No newline at end of file
+} // namespace yanhon
@@ -0,0 +1,239 @@
+#include "monitor/drop_reason_monitor.hpp"
+#include <algorithm>
+#include <bpf/bpf.h>
+#include <bpf/btf.h>
+#include <bpf/libbpf.h>
+#include <net/if.h>
+#include <string.h>
+#include <iostream>
+
+#include "drop_reason.skel.h"
+
+namespace yanhon {
+static const char kReasonPrefix[] = "SKB_DROP_REASON_";
+// 连续这么多次采集没有增长的 key 从 Map 中删除，为新 key 腾出空间
+static constexpr uint32_t kIdleTicksToEvict = 60;
+
+DropReasonMonitor::DropReasonMonitor(size_t top_n) : top_n_(top_n) {
+  if (!LoadBpf()) {
+    std::cerr << "kfree_skb BPF unavailable, drop reasons disabled"
+              << std::endl;
+    return;
+  }
+  LoadReasonNames();
+}
+
+DropReasonMonitor::~DropReasonMonitor() { Stop(); }
+
+bool DropReasonMonitor::LoadBpf() {
+  ncpus_ = libbpf_num_possible_cpus();
+  if (ncpus_ <= 0) {
+    return false;
+  }
+  skel_ = drop_reason_bpf__open_and_load();
+  if (!skel_) {
+    return false;
+  }
+  if (drop_reason_bpf__attach(skel_) != 0) {
+    drop_reason_bpf__destroy(skel_);
+    skel_ = nullptr;
+    return false;
+  }
+  percpu_vals_.resize(ncpus_);
+  return true;
+}
+
+/**
+ * @brief 由 vmlinux BTF 建立 reason 取值到名称的映射
+ * 去掉 SKB_DROP_REASON_ 前缀，例如 2 -> NOT_SPECIFIED
+ */
+void DropReasonMonitor::LoadReasonNames() {
+  struct btf *btf = btf__load_vmlinux_btf();
+  if (!btf) {
+    std::cerr << "Failed to load vmlinux BTF, drop reasons shown as numbers"
+              << std::endl;
+    return;
+  }
+  int id = btf__find_by_name_kind(btf, "skb_drop_reason", BTF_KIND_ENUM);
+  if (id > 0) {
+    const struct btf_type *t = btf__type_by_id(btf, id);
+    const struct btf_enum *e = btf_enum(t);
+    for (int i = 0; i < btf_vlen(t); ++i, ++e) {
+      const char *name = btf__name_by_offset(btf, e->name_off);
+      if (!name) {
+        continue;
+      }
+      if (strncmp(name, kReasonPrefix, sizeof(kReasonPrefix) - 1) == 0) {
+        name += sizeof(kReasonPrefix) - 1;
+      }
+      reason_names_[e->val] = name;
+    }
+  }
+  btf__free(btf);
+}
+
+const std::string &DropReasonMonitor::ReasonName(uint32_t reason) {
+  auto it = reason_names_.find(reason);
+  if (it == reason_names_.end()) {
+    it = reason_names_.emplace(reason, std::to_string(reason)).first;
+  }
+  return it->second;
+}
+
+/**
+ * @brief ifindex 转网卡名并缓存；0 表示已脱离设备的本地路径丢包
+ */
+const std::string &DropReasonMonitor::InterfaceName(uint32_t ifindex) {
+  auto it = if_names_.find(ifindex);
+  if (it != if_names_.end()) {
+    return it->second;
+  }
+  char name[IF_NAMESIZE] = {};
+  std::string value;
+  if (ifindex == 0) {
+    value = "local";
+  } else if (if_indextoname(ifindex, name)) {
+    value = name;
+  } else {
+    value = "if" + std::to_string(ifindex);
+  }
+  return if_names_.emplace(ifindex, std::move(value)).first->second;
+}
+
+/**
+ * @brief 汇总各 CPU 的累计计数，与上次采集相减得到本周期的丢包
+ * Map 容量有限，网卡删除后其 key 不会再增长：所在网卡已不存在或连续
+ * kIdleTicksToEvict 次没有增长的 key 在采集后删除。删除前最后一次读取
+ * 之后的计数会丢失，长期静止的 key 上这种情况很少
+ */
+void DropReasonMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (!skel_) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+
+  int map_fd = bpf_map__fd(skel_->maps.drop_count);
+  std::unordered_map<uint64_t, Counter> cur;
+  cur.reserve(last_.size());
+  drop_key key;
+  drop_key *prev = nullptr;
+  while (bpf_map_get_next_key(map_fd, prev, &key) == 0) {
+    prev = &key;
+    if (bpf_map_lookup_elem(map_fd, &key, percpu_vals_.data()) != 0) {
+      continue;
+    }
+    uint64_t sum = 0;
+    for (uint64_t v : percpu_vals_) {
+      sum += v;
+    }
+    auto it = last_.find(Pack(key));
+    uint32_t idle = 0;
+    if (it != last_.end() && it->second.count == sum) {
+      idle = it->second.idle_ticks + 1;
+    }
+    cur[Pack(key)] = {sum, idle};
+  }
+
+  if (has_last_ && dt > 0) {
+    struct Reason {
+      uint32_t reason;
+      uint64_t count;
+    };
+    struct Interface {
+      uint32_t ifindex;
+      uint64_t total = 0;
+      std::vector<Reason> reasons;
+    };
+    std::unordered_map<uint32_t, Interface> per_if;
+    for (const auto &[packed, counter] : cur) {
+      auto it = last_.find(packed);
+      uint64_t before = it == last_.end() ? 0 : it->second.count;
+      uint64_t count = counter.count;
+      uint64_t delta = count >= before ? count - before : 0;
+      if (delta == 0) {
+        continue;
+      }
+      uint32_t ifindex = packed >> 32;
+      auto &iface = per_if[ifindex];
+      iface.ifindex = ifindex;
+      iface.total += delta;
+      iface.reasons.push_back({static_cast<uint32_t>(packed), delta});
+    }
+
+    std::vector<Interface *> ifaces;
+    ifaces.reserve(per_if.size());
+    for (auto &[ifindex, iface] : per_if) {
+      ifaces.push_back(&iface);
+    }
+    std::sort(ifaces.begin(), ifaces.end(),
+              [](const Interface *a, const Interface *b) {
+                return a->total > b->total;
+              });
+    for (Interface *iface : ifaces) {
+      auto drops_msg = monitor_info->add_drop_reasons();
+      drops_msg->set_name(InterfaceName(iface->ifindex));
+      drops_msg->set_total_rate(iface->total / dt);
+      auto &reasons = iface->reasons;
+      size_t n = std::min(top_n_, reasons.size());
+      std::partial_sort(reasons.begin(), reasons.begin() + n, reasons.end(),
+                        [](const Reason &a, const Reason &b) {
+                          return a.count > b.count;
+                        });
+      for (size_t i = 0; i < n; ++i) {
+        auto reason_msg = drops_msg->add_reasons();
+        reason_msg->set_reason(ReasonName(reasons[i].reason));
+        reason_msg->set_count(reasons[i].count);
+        reason_msg->set_rate(reasons[i].count / dt);
+      }
+    }
+  }
+
+  last_ = std::move(cur);
+  last_time_ = now;
+  has_last_ = true;
+  EvictStale(map_fd);
+}
+
+/**
+ * @brief 删除网卡已不存在或长期没有增长的 key
+ * 删除后同一 key 再次出现时从 0 开始计数，因此同时从 last_ 中移除
+ */
+void DropReasonMonitor::EvictStale(int map_fd) {
+  std::unordered_map<uint32_t, bool> if_alive;
+  for (auto it = last_.begin(); it != last_.end();) {
+    const Counter &counter = it->second;
+    if (counter.idle_ticks == 0) {
+      ++it;
+      continue;
+    }
+    drop_key key = Unpack(it->first);
+    bool evict = counter.idle_ticks >= kIdleTicksToEvict;
+    if (!evict && key.ifindex != 0) {
+      auto alive = if_alive.find(key.ifindex);
+      if (alive == if_alive.end()) {
+        char name[IF_NAMESIZE];
+        bool exists = if_indextoname(key.ifindex, name) != nullptr;
+        alive = if_alive.emplace(key.ifindex, exists).first;
+        if (!exists) {
+          // ifindex 可能被新网卡复用，不再沿用缓存的旧名称
+          if_names_.erase(key.ifindex);
+        }
+      }
+      evict = !alive->second;
+    }
+    if (evict && bpf_map_delete_elem(map_fd, &key) == 0) {
+      it = last_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void DropReasonMonitor::Stop() {
+  if (skel_) {
+    drop_reason_bpf__destroy(skel_);
+    skel_ = nullptr;
+  }
+}
+} // namespace yanhon
@@ -0,0 +1,214 @@
+#include "monitor/fs_monitor.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/statvfs.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+
+namespace yanhon {
+// 增长速率的指数平滑系数，抑制单个周期内的写入抖动
+static constexpr double kFillRateAlpha = 0.3;
+
+static const char *next_field(const char *p, const char *end) {
+  while (p < end && *p != ' ') {
+    ++p;
+  }
+  return p < end ? p + 1 : end;
+}
+
+static std::string field_string(const char *p, const char *end) {
+  const char *e = p;
+  while (e < end && *e != ' ') {
+    ++e;
+  }
+  return std::string(p, e);
+}
+
+/**
+ * @brief 还原 mountinfo 中的八进制转义（空格为 \040，换行为 \012 等）
+ */
+static std::string unescape(const std::string &s) {
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '\\' && i + 3 < s.size() && s[i + 1] >= '0' &&
+        s[i + 1] <= '3') {
+      int c = (s[i + 1] - '0') << 6 | (s[i + 2] - '0') << 3 | (s[i + 3] - '0');
+      out.push_back(static_cast<char>(c));
+      i += 3;
+    } else {
+      out.push_back(s[i]);
+    }
+  }
+  return out;
+}
+
+FsMonitor::FsMonitor() : buf_(64 * 1024) {
+  LoadNodevTypes();
+  mountinfo_fd_ = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+  if (mountinfo_fd_ < 0) {
+    std::cerr << "Failed to open /proc/self/mountinfo: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+FsMonitor::~FsMonitor() { Stop(); }
+
+/**
+ * @brief 读取 /proc/filesystems 中标记为 nodev 的文件系统类型
+ * 文件系统类型只在加载内核模块时增加，启动时读取一次
+ */
+void FsMonitor::LoadNodevTypes() {
+  std::ifstream ifs("/proc/filesystems");
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.compare(0, 5, "nodev") == 0) {
+      size_t pos = line.find_first_not_of(" \t", 5);
+      if (pos != std::string::npos) {
+        nodev_types_.insert(line.substr(pos));
+      }
+    }
+  }
+}
+
+/**
+ * @brief 挂载表自上次 poll 以来是否发生变化
+ * 内核在 poll 时记录当前的挂载事件序号，因此变化只会被报告一次
+ */
+bool FsMonitor::MountsChanged() {
+  struct pollfd pfd;
+  pfd.fd = mountinfo_fd_;
+  pfd.events = POLLPRI;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, 0) < 0) {
+    return true;
+  }
+  return pfd.revents & (POLLPRI | POLLERR);
+}
+
+void FsMonitor::ParseMountInfo() {
+  ssize_t n;
+  while (true) {
+    n = pread(mountinfo_fd_, buf_.data(), buf_.size(), 0);
+    if (n < 0) {
+      std::cerr << "Failed to read /proc/self/mountinfo: " << strerror(errno)
+                << std::endl;
+      return;
+    }
+    if (static_cast<size_t>(n) < buf_.size()) {
+      break;
+    }
+    // 缓冲区被读满，说明内容可能被截断
+    buf_.resize(buf_.size() * 2);
+  }
+
+  mounts_.clear();
+  std::unordered_map<uint64_t, size_t> by_dev;
+  const char *p = buf_.data();
+  const char *end = p + n;
+  while (p < end) {
+    const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+    if (!eol) {
+      eol = end;
+    }
+    // 格式：id parent major:minor root mount_point options [optional...] -
+    //       fs_type source super_options
+    const char *f = next_field(next_field(p, eol), eol);
+    unsigned major = 0, minor = 0;
+    sscanf(f, "%u:%u", &major, &minor);
+    f = next_field(f, eol);
+    bool root = eol - f > 1 && f[0] == '/' && f[1] == ' ';
+    f = next_field(f, eol);
+    const char *mount_point = f;
+    const char *sep = static_cast<const char *>(memmem(f, eol - f, " - ", 3));
+    if (sep) {
+      const char *fs_type = sep + 3;
+      const char *source = next_field(fs_type, eol);
+      MountEntry entry;
+      entry.fs_type = field_string(fs_type, eol);
+      bool real = nodev_types_.empty() ? major != 0
+                                       : !nodev_types_.count(entry.fs_type);
+      if (real) {
+        entry.dev = makedev(major, minor);
+        entry.mount_point = unescape(field_string(mount_point, eol));
+        entry.source = unescape(field_string(source, eol));
+        entry.root = root;
+        auto it = by_dev.find(entry.dev);
+        if (it == by_dev.end()) {
+          by_dev.emplace(entry.dev, mounts_.size());
+          mounts_.push_back(std::move(entry));
+        } else if (root && !mounts_[it->second].root) {
+          // 优先使用挂载文件系统根目录的挂载点，而不是 bind 进来的子目录
+          mounts_[it->second] = std::move(entry);
+        }
+      }
+    }
+    p = eol + 1;
+  }
+  mounts_valid_ = true;
+}
+
+void FsMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (mountinfo_fd_ < 0) {
+    return;
+  }
+  if (MountsChanged() || !mounts_valid_) {
+    ParseMountInfo();
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+  last_time_ = now;
+
+  std::unordered_map<uint64_t, Usage> usage;
+  usage.reserve(mounts_.size());
+  for (const auto &mount : mounts_) {
+    struct statvfs st;
+    if (statvfs(mount.mount_point.c_str(), &st) != 0 || st.f_blocks == 0) {
+      continue;
+    }
+    uint64_t total = static_cast<uint64_t>(st.f_blocks) * st.f_frsize;
+    uint64_t used =
+        static_cast<uint64_t>(st.f_blocks - st.f_bfree) * st.f_frsize;
+    uint64_t avail = static_cast<uint64_t>(st.f_bavail) * st.f_frsize;
+
+    Usage &cur = usage[mount.dev];
+    cur.used_bytes = used;
+    auto it = usage_.find(mount.dev);
+    if (it != usage_.end() && dt > 0) {
+      double rate = (static_cast<double>(used) - it->second.used_bytes) / dt;
+      cur.fill_rate = kFillRateAlpha * rate +
+                      (1 - kFillRateAlpha) * it->second.fill_rate;
+    }
+
+    auto fs_msg = monitor_info->add_fs_info();
+    fs_msg->set_mount_point(mount.mount_point);
+    fs_msg->set_fs_type(mount.fs_type);
+    fs_msg->set_source(mount.source);
+    fs_msg->set_read_only(st.f_flag & ST_RDONLY);
+    fs_msg->set_total_bytes(total);
+    fs_msg->set_used_bytes(used);
+    fs_msg->set_avail_bytes(avail);
+    // 与 df 一致，分母不含 root 预留块
+    fs_msg->set_used_percent(used + avail > 0 ? used * 100.0 / (used + avail)
+                                              : 0);
+    fs_msg->set_inodes_total(st.f_files);
+    fs_msg->set_inodes_used(st.f_files - st.f_ffree);
+    fs_msg->set_inodes_percent(
+        st.f_files > 0 ? (st.f_files - st.f_ffree) * 100.0 / st.f_files : 0);
+    fs_msg->set_fill_rate(cur.fill_rate);
+    fs_msg->set_seconds_to_full(cur.fill_rate > 0 ? avail / cur.fill_rate
+                                                  : 0);
+  }
+  usage_ = std::move(usage);
+}
+
+void FsMonitor::Stop() {
+  if (mountinfo_fd_ >= 0) {
+    close(mountinfo_fd_);
+    mountinfo_fd_ = -1;
+  }
+}
+} // namespace yanhon
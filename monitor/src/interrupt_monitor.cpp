@@ -0,0 +1,294 @@
+#include "monitor/interrupt_monitor.hpp"
+#include <algorithm>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <unordered_map>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace yanhon {
+// 缓冲区尾部预留的字节数，保证 16 字节向量加载不越界
+static constexpr size_t kPad = 16;
+
+/**
+ * @brief 返回 [p, end) 中第一个不是空格的位置
+ */
+static const char *skip_spaces(const char *p, const char *end) {
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  while (p + 16 <= end) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    unsigned mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, space)) & 0xffff;
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && *p == ' ') {
+    ++p;
+  }
+  return p;
+}
+
+/**
+ * @brief 返回 [p, end) 中第一个不是数字的位置
+ */
+static const char *skip_digits(const char *p, const char *end) {
+#if defined(__SSE2__)
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i nine = _mm_set1_epi8(9);
+  while (p + 16 <= end) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    // c - '0' 按无符号比较 <= 9 即为数字，SSE2 没有无符号比较，用 max 代替
+    __m128i t = _mm_sub_epi8(v, zero);
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_max_epu8(t, nine), nine);
+    unsigned mask = ~_mm_movemask_epi8(is_digit) & 0xffff;
+    if (mask) {
+      return p + __builtin_ctz(mask);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && static_cast<unsigned char>(*p - '0') <= 9) {
+    ++p;
+  }
+  return p;
+}
+
+static uint64_t to_uint(const char *p, const char *end) {
+  uint64_t value = 0;
+  for (; p < end; ++p) {
+    value = value * 10 + (*p - '0');
+  }
+  return value;
+}
+
+/**
+ * @brief 不均衡度：最忙 CPU 相对平均值的倍数归一化到 [0, 1]，
+ * 0 表示完全均匀，1 表示全部落在一个 CPU 上
+ */
+static float imbalance(const float *rate, size_t n, int *busiest) {
+  double sum = 0;
+  size_t max_i = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += rate[i];
+    if (rate[i] > rate[max_i]) {
+      max_i = i;
+    }
+  }
+  *busiest = max_i;
+  if (n <= 1 || sum <= 0) {
+    return 0;
+  }
+  double ratio = rate[max_i] / (sum / n);
+  return (ratio - 1) / (n - 1);
+}
+
+/**
+ * @brief 提取行尾的描述文字，连续空白压缩为一个空格
+ */
+static std::string trim_desc(const char *p, const char *end) {
+  std::string desc;
+  bool space = false;
+  for (; p < end && *p != '\n'; ++p) {
+    if (*p == ' ' || *p == '\t') {
+      space = !desc.empty();
+      continue;
+    }
+    if (space) {
+      desc.push_back(' ');
+      space = false;
+    }
+    desc.push_back(*p);
+  }
+  return desc;
+}
+
+InterruptMonitor::InterruptMonitor(size_t top_n)
+    : top_n_(top_n), buf_(64 * 1024 + kPad) {
+  fd_ = open("/proc/interrupts", O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    std::cerr << "Failed to open /proc/interrupts: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+InterruptMonitor::~InterruptMonitor() { Stop(); }
+
+/**
+ * @brief 解析表头 "CPU0 CPU1 ..."，CPU 集合变化（热插拔）时丢弃上次数据
+ */
+bool InterruptMonitor::ParseHeader(const char *p, const char *end) {
+  std::vector<int32_t> cpus;
+  while ((p = skip_spaces(p, end)) < end) {
+    if (end - p > 3 && memcmp(p, "CPU", 3) == 0) {
+      const char *q = skip_digits(p + 3, end);
+      cpus.push_back(to_uint(p + 3, q));
+      p = q;
+    } else {
+      ++p;
+    }
+  }
+  if (cpus.empty()) {
+    return false;
+  }
+  if (cpus != cpus_) {
+    cpus_.swap(cpus);
+    has_last_ = false;
+  }
+  return true;
+}
+
+bool InterruptMonitor::Read() {
+  while (true) {
+    ssize_t n = pread(fd_, buf_.data(), buf_.size() - kPad, 0);
+    if (n <= 0) {
+      return false;
+    }
+    if (static_cast<size_t>(n) < buf_.size() - kPad) {
+      len_ = n;
+      break;
+    }
+    // 缓冲区被读满，说明内容可能被截断
+    buf_.resize(buf_.size() * 2);
+  }
+
+  const char *p = buf_.data();
+  const char *end = p + len_;
+  const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+  if (!nl || !ParseHeader(p, nl)) {
+    return false;
+  }
+  size_t ncpu = cpus_.size();
+  labels_.clear();
+  counts_.clear();
+  desc_offset_.clear();
+  for (p = nl + 1; p < end; p = nl + 1) {
+    nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    if (!nl) {
+      nl = end;
+    }
+    p = skip_spaces(p, nl);
+    const char *colon = static_cast<const char *>(memchr(p, ':', nl - p));
+    if (!colon) {
+      continue;
+    }
+    size_t base = counts_.size();
+    counts_.resize(base + ncpu);
+    const char *q = colon + 1;
+    size_t col = 0;
+    for (; col < ncpu; ++col) {
+      q = skip_spaces(q, nl);
+      const char *digits_end = skip_digits(q, nl);
+      if (digits_end == q) {
+        break;
+      }
+      counts_[base + col] = to_uint(q, digits_end);
+      q = digits_end;
+    }
+    if (col < ncpu) {
+      // ERR、MIS 等只有一列的全局计数
+      counts_.resize(base);
+      continue;
+    }
+    labels_.emplace_back(p, colon - p);
+    desc_offset_.push_back(q - buf_.data());
+  }
+  return true;
+}
+
+void InterruptMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (fd_ < 0 || !Read()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+  size_t ncpu = cpus_.size();
+  size_t nrows = labels_.size();
+
+  if (has_last_ && dt > 0) {
+    // 中断号集合不变时按行对齐，否则（设备增删）按名字找上次的行
+    bool same_layout = labels_ == last_labels_;
+    std::unordered_map<std::string, size_t> last_row;
+    if (!same_layout) {
+      for (size_t r = 0; r < last_labels_.size(); ++r) {
+        last_row.emplace(last_labels_[r], r);
+      }
+    }
+
+    std::vector<float> rates(nrows * ncpu);
+    std::vector<std::pair<double, size_t>> active;
+    std::vector<float> cpu_total(ncpu);
+    double total = 0;
+    for (size_t r = 0; r < nrows; ++r) {
+      size_t lr = r;
+      if (!same_layout) {
+        auto it = last_row.find(labels_[r]);
+        if (it == last_row.end()) {
+          continue;
+        }
+        lr = it->second;
+      }
+      const uint64_t *cur = &counts_[r * ncpu];
+      const uint64_t *last = &last_counts_[lr * ncpu];
+      float *rate = &rates[r * ncpu];
+      double row_total = 0;
+      for (size_t c = 0; c < ncpu; ++c) {
+        rate[c] = cur[c] >= last[c] ? (cur[c] - last[c]) / dt : 0;
+        row_total += rate[c];
+        cpu_total[c] += rate[c];
+      }
+      if (row_total > 0) {
+        active.emplace_back(row_total, r);
+        total += row_total;
+      }
+    }
+
+    size_t n = std::min(top_n_, active.size());
+    std::partial_sort(active.begin(), active.begin() + n, active.end(),
+                      [](const auto &a, const auto &b) {
+                        return a.first > b.first;
+                      });
+
+    auto irq_msg = monitor_info->mutable_interrupt_info();
+    for (int32_t cpu : cpus_) {
+      irq_msg->add_cpus(cpu);
+    }
+    irq_msg->set_total_rate(total);
+    irq_msg->set_active_irqs(active.size());
+    for (float rate : cpu_total) {
+      irq_msg->add_cpu_total_rate(rate);
+    }
+    int busiest;
+    irq_msg->set_cpu_imbalance(imbalance(cpu_total.data(), ncpu, &busiest));
+    for (size_t i = 0; i < n; ++i) {
+      size_t r = active[i].second;
+      const float *rate = &rates[r * ncpu];
+      auto stat = irq_msg->add_irqs();
+      stat->set_irq(labels_[r]);
+      stat->set_name(trim_desc(buf_.data() + desc_offset_[r],
+                               buf_.data() + len_));
+      stat->set_rate(active[i].first);
+      stat->mutable_cpu_rate()->Add(rate, rate + ncpu);
+      stat->set_imbalance(imbalance(rate, ncpu, &busiest));
+      stat->set_busiest_cpu(cpus_[busiest]);
+    }
+  }
+
+  labels_.swap(last_labels_);
+  counts_.swap(last_counts_);
+  last_time_ = now;
+  has_last_ = true;
+}
+
+void InterruptMonitor::Stop() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+} // namespace yanhon
@@ -11,6 +11,8 @@
 #include <bpf/libbpf.h>
 #include <bpf/bpf.h>
 #include <unistd.h>
+#include <linux/gen_stats.h>
+#include <linux/pkt_sched.h>
 #include <linux/rtnetlink.h>
 #include <sys/socket.h>
 #include <string.h>
@@ -314,6 +316,105 @@ static std::unordered_map<std::string, NetStat> proc_get_net_err_drop_stats() {
   return std::move(stats_map);
 }
 
+// ----------------------------------------------------------------------
+// netlink 部分：负责 qdisc 的排队与丢包
+// ----------------------------------------------------------------------
+
+/**
+ * @brief 解析 TCA_STATS2 中的嵌套属性
+ */
+static void parse_qdisc_stats2(const struct rtattr *stats2, QdiscStat *q) {
+  const struct rtattr *rta =
+      static_cast<const struct rtattr *>(RTA_DATA(stats2));
+  int len = RTA_PAYLOAD(stats2);
+  for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if (rta->rta_type == TCA_STATS_BASIC &&
+        RTA_PAYLOAD(rta) >= sizeof(struct gnet_stats_basic)) {
+      struct gnet_stats_basic basic;
+      memcpy(&basic, RTA_DATA(rta), sizeof(basic));
+      q->bytes = basic.bytes;
+    } else if (rta->rta_type == TCA_STATS_QUEUE &&
+               RTA_PAYLOAD(rta) >= sizeof(struct gnet_stats_queue)) {
+      struct gnet_stats_queue queue;
+      memcpy(&queue, RTA_DATA(rta), sizeof(queue));
+      q->qlen = queue.qlen;
+      q->backlog = queue.backlog;
+      q->drops = queue.drops;
+      q->overlimits = queue.overlimits;
+      q->requeues = queue.requeues;
+    }
+  }
+}
+
+/**
+ * @brief 通过 RTM_GETQDISC dump 所有 qdisc，只取被监控接口的根 qdisc
+ * mq 等多队列根 qdisc 在 dump 时已经汇总了各子队列的统计，子 qdisc 不再累加；
+ * ingress/clsact 不属于出方向，同样跳过
+ * @return 接口名 -> 根 qdisc 统计
+ */
+std::unordered_map<std::string, QdiscStat>
+NetMonitor::netlink_get_qdisc_stats() {
+  std::unordered_map<std::string, QdiscStat> qdisc_map;
+  if (qdisc_sock_ < 0) {
+    return qdisc_map;
+  }
+
+  struct {
+    struct nlmsghdr nlh;
+    struct tcmsg tcm;
+  } req;
+  memset(&req, 0, sizeof(req));
+  req.nlh.nlmsg_len = sizeof(req);
+  req.nlh.nlmsg_type = RTM_GETQDISC;
+  req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.nlh.nlmsg_seq = ++qdisc_seq_;
+  req.tcm.tcm_family = AF_UNSPEC;
+  if (send(qdisc_sock_, &req, sizeof(req), 0) < 0) {
+    perror("send RTM_GETQDISC");
+    return qdisc_map;
+  }
+
+  char buf[32 * 1024];
+  while (true) {
+    ssize_t len = recv(qdisc_sock_, buf, sizeof(buf), 0);
+    if (len <= 0) {
+      return qdisc_map;
+    }
+    for (struct nlmsghdr *nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, len);
+         nlh = NLMSG_NEXT(nlh, len)) {
+      if (nlh->nlmsg_seq != qdisc_seq_) {
+        continue;
+      }
+      if (nlh->nlmsg_type == NLMSG_DONE || nlh->nlmsg_type == NLMSG_ERROR) {
+        return qdisc_map;
+      }
+      if (nlh->nlmsg_type != RTM_NEWQDISC) {
+        continue;
+      }
+      struct tcmsg *tcm = (struct tcmsg *)NLMSG_DATA(nlh);
+      if (tcm->tcm_parent != TC_H_ROOT) {
+        continue;
+      }
+      auto if_it = ifindex_map.find(tcm->tcm_ifindex);
+      if (if_it == ifindex_map.end()) {
+        continue;
+      }
+
+      QdiscStat q = {};
+      struct rtattr *rta = TCA_RTA(tcm);
+      int rtalen = TCA_PAYLOAD(nlh);
+      for (; RTA_OK(rta, rtalen); rta = RTA_NEXT(rta, rtalen)) {
+        if (rta->rta_type == TCA_KIND) {
+          q.kind = (const char *)RTA_DATA(rta);
+        } else if (rta->rta_type == TCA_STATS2) {
+          parse_qdisc_stats2(rta, &q);
+        }
+      }
+      qdisc_map[if_it->second] = q;
+    }
+  }
+}
+
 // ----------------------------------------------------------------------
 // NetMonitor::UpdateOnce 实现 (合并逻辑)
 // ----------------------------------------------------------------------
@@ -336,6 +437,11 @@ NetMonitor::NetMonitor() {
     return;
   }
 
+  qdisc_sock_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (qdisc_sock_ < 0) {
+    perror("socket NETLINK_ROUTE for qdisc");
+  }
+
   printf("Found %zu network interfaces:\n", ifindex_map.size());
   int idx = 0;
   for (const auto &pair : ifindex_map) {
@@ -542,7 +648,11 @@ void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
   std::unordered_map<std::string, NetStat> proc_stats =
       proc_get_net_err_drop_stats();
 
-  // 3. 合并数据：以 eBPF 数据为主，填充 /proc 的 err/drop
+  // 3. 获取出方向根 qdisc 的排队与丢包统计 (netlink 负责)
+  std::unordered_map<std::string, QdiscStat> qdisc_stats =
+      netlink_get_qdisc_stats();
+
+  // 4. 合并数据：以 eBPF 数据为主，填充 /proc 的 err/drop
   std::vector<NetStat> current_stats;
   for (const auto &pair : ebpf_stats) {
     const std::string &ifname = pair.first;
@@ -572,13 +682,18 @@ void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
     current_stats.push_back(s);
   }
 
-  // 4. 遍历当前统计数据，计算速率，并更新缓存
+  // 5. 遍历当前统计数据，计算速率，并更新缓存
   for (const auto &stat : current_stats) {
     auto it = last_net_info_.find(stat.name);
+    auto qdisc_it = qdisc_stats.find(stat.name);
+    const QdiscStat *qdisc =
+        qdisc_it != qdisc_stats.end() ? &qdisc_it->second : nullptr;
     float rcv_rate = 0, rcv_packets_rate = 0, send_rate = 0,
           send_packets_rate = 0;
     float err_in_rate = 0, err_out_rate = 0, drop_in_rate = 0,
           drop_out_rate = 0;
+    float qdisc_byte_rate = 0, qdisc_drop_rate = 0, qdisc_overlimit_rate = 0,
+          qdisc_requeue_rate = 0;
 
     if (it != last_net_info_.end()) {
       const NetInfo &last = it->second;
@@ -598,6 +713,23 @@ void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
         drop_in_rate = (stat.drop_in - last.drop_in) / dt;
         drop_out_rate = (stat.drop_out - last.drop_out) / dt;
       }
+
+      // 计算 qdisc 速率 (netlink 数据)；qdisc 被替换后计数从 0 开始，
+      // 任一计数回退时只重建基线
+      double qdisc_dt =
+          std::chrono::duration<double>(now - last.qdisc_timepoint).count();
+      if (qdisc && last.has_qdisc && qdisc_dt > 0 &&
+          qdisc->bytes >= last.qdisc_bytes &&
+          qdisc->drops >= last.qdisc_drops &&
+          qdisc->overlimits >= last.qdisc_overlimits &&
+          qdisc->requeues >= last.qdisc_requeues) {
+        qdisc_byte_rate = (qdisc->bytes - last.qdisc_bytes) / qdisc_dt;
+        qdisc_drop_rate = (qdisc->drops - last.qdisc_drops) / qdisc_dt;
+        qdisc_overlimit_rate =
+            (qdisc->overlimits - last.qdisc_overlimits) / qdisc_dt;
+        qdisc_requeue_rate =
+            (qdisc->requeues - last.qdisc_requeues) / qdisc_dt;
+      }
     }
 
     // 填充 protobuf
@@ -620,8 +752,23 @@ void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
     net_info->set_drop_in_rate(drop_in_rate);
     net_info->set_drop_out_rate(drop_out_rate);
 
+    // netlink 提供的 qdisc 统计
+    if (qdisc) {
+      net_info->set_qdisc_kind(qdisc->kind);
+      net_info->set_qdisc_backlog_bytes(qdisc->backlog);
+      net_info->set_qdisc_backlog_packets(qdisc->qlen);
+      net_info->set_qdisc_drop_rate(qdisc_drop_rate);
+      net_info->set_qdisc_overlimit_rate(qdisc_overlimit_rate);
+      net_info->set_qdisc_requeue_rate(qdisc_requeue_rate);
+      // Little 定律：排队时延 ≈ 排队字节数 / 出队速率
+      if (qdisc_byte_rate > 0) {
+        net_info->set_qdisc_delay_ms(qdisc->backlog * 1000.0 /
+                                     qdisc_byte_rate);
+      }
+    }
+
     // 更新缓存
-    NetInfo new_info;
+    NetInfo new_info{};
     new_info.name = stat.name;
     new_info.rcv_bytes = stat.rcv_bytes;
     new_info.rcv_packets = stat.rcv_packets;
@@ -632,6 +779,23 @@ void NetMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
     new_info.drop_in = stat.drop_in;
     new_info.drop_out = stat.drop_out;
     new_info.timepoint = now;
+    if (qdisc) {
+      new_info.qdisc_bytes = qdisc->bytes;
+      new_info.qdisc_drops = qdisc->drops;
+      new_info.qdisc_overlimits = qdisc->overlimits;
+      new_info.qdisc_requeues = qdisc->requeues;
+      new_info.has_qdisc = true;
+      new_info.qdisc_timepoint = now;
+    } else if (it != last_net_info_.end()) {
+      // 本次 dump 没有拿到该网卡（recv 失败或 qdisc 正在替换），沿用旧基线
+      const NetInfo &last = it->second;
+      new_info.qdisc_bytes = last.qdisc_bytes;
+      new_info.qdisc_drops = last.qdisc_drops;
+      new_info.qdisc_overlimits = last.qdisc_overlimits;
+      new_info.qdisc_requeues = last.qdisc_requeues;
+      new_info.has_qdisc = last.has_qdisc;
+      new_info.qdisc_timepoint = last.qdisc_timepoint;
+    }
     last_net_info_[stat.name] = new_info;
   }
 }
@@ -658,6 +822,9 @@ NetMonitor::~NetMonitor() { // 分离TC程序并销毁TC钩子
   free(hooks_created_egress);
 
   net_monitor_bpf__destroy(skel);
+  if (qdisc_sock_ >= 0) {
+    close(qdisc_sock_);
+  }
   printf("Network monitor stopped.\n");
 }
 
@@ -0,0 +1,150 @@
+#include "monitor/numa_monitor.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <string>
+
+namespace yanhon {
+static constexpr float KBToGB = 1000 * 1000;
+static const char *kNodeRoot = "/sys/devices/system/node";
+
+/**
+ * @brief 在 buf 中查找 key 并解析其后的数值，
+ * meminfo 每行形如 "Node 0 MemTotal:   16315464 kB"
+ */
+static uint64_t find_value(const char *buf, const char *key) {
+  const char *p = strstr(buf, key);
+  if (!p) {
+    return 0;
+  }
+  return strtoull(p + strlen(key), nullptr, 10);
+}
+
+static ssize_t pread_all(int fd, char *buf, size_t size) {
+  ssize_t n = pread(fd, buf, size - 1, 0);
+  if (n < 0) {
+    return -1;
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+/** @brief 累计计数的增量，节点下线后重新上线等导致计数回退时为 0 */
+static uint64_t counter_delta(uint64_t cur, uint64_t last) {
+  return cur >= last ? cur - last : 0;
+}
+
+NumaMonitor::NumaMonitor() {
+  DIR *dir = opendir(kNodeRoot);
+  if (!dir) {
+    // 未开启 CONFIG_NUMA 的内核没有该目录
+    return;
+  }
+  while (struct dirent *de = readdir(dir)) {
+    if (strncmp(de->d_name, "node", 4) != 0 || de->d_name[4] < '0' ||
+        de->d_name[4] > '9') {
+      continue;
+    }
+    Node node;
+    node.id = strtoul(de->d_name + 4, nullptr, 10);
+    std::string base = std::string(kNodeRoot) + "/" + de->d_name;
+    node.meminfo_fd = open((base + "/meminfo").c_str(), O_RDONLY | O_CLOEXEC);
+    node.numastat_fd =
+        open((base + "/numastat").c_str(), O_RDONLY | O_CLOEXEC);
+    if (node.meminfo_fd < 0) {
+      if (node.numastat_fd >= 0)
+        close(node.numastat_fd);
+      continue;
+    }
+    nodes_.push_back(node);
+  }
+  closedir(dir);
+  std::sort(nodes_.begin(), nodes_.end(),
+            [](const Node &a, const Node &b) { return a.id < b.id; });
+  last_time_ = std::chrono::steady_clock::now();
+}
+
+NumaMonitor::~NumaMonitor() { Stop(); }
+
+void NumaMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+  last_time_ = now;
+
+  char buf[4096];
+  for (auto &node : nodes_) {
+    if (pread_all(node.meminfo_fd, buf, sizeof(buf)) <= 0) {
+      continue;
+    }
+    auto numa_msg = monitor_info->add_numa_info();
+    numa_msg->set_node(node.id);
+
+    uint64_t total = find_value(buf, "MemTotal:");
+    uint64_t free = find_value(buf, "MemFree:");
+    uint64_t used = find_value(buf, "MemUsed:");
+    numa_msg->set_total(total / KBToGB);
+    numa_msg->set_free(free / KBToGB);
+    numa_msg->set_used(used / KBToGB);
+    uint64_t file_pages = find_value(buf, "FilePages:");
+    uint64_t s_reclaimable = find_value(buf, "SReclaimable:");
+    numa_msg->set_file_pages(file_pages / KBToGB);
+    numa_msg->set_anon_pages(find_value(buf, "AnonPages:") / KBToGB);
+    numa_msg->set_active_file(find_value(buf, "Active(file):") / KBToGB);
+    numa_msg->set_inactive_file(find_value(buf, "Inactive(file):") / KBToGB);
+    numa_msg->set_slab(find_value(buf, "Slab:") / KBToGB);
+    // 节点 meminfo 没有 MemAvailable，用 free + 页缓存 + 可回收 slab 近似，
+    // 与 MemInfo.used_percent 的 (total - avail) / total 口径保持一致
+    uint64_t avail = free + file_pages + s_reclaimable;
+    numa_msg->set_used_percent(
+        total > avail ? (total - avail) * 100.0 / total : 0);
+
+    if (node.numastat_fd < 0 ||
+        pread_all(node.numastat_fd, buf, sizeof(buf)) <= 0) {
+      continue;
+    }
+    NumaStat cur;
+    cur.numa_hit = find_value(buf, "numa_hit ");
+    cur.numa_miss = find_value(buf, "numa_miss ");
+    cur.numa_foreign = find_value(buf, "numa_foreign ");
+    cur.interleave_hit = find_value(buf, "interleave_hit ");
+    cur.local_node = find_value(buf, "local_node ");
+    cur.other_node = find_value(buf, "other_node ");
+
+    if (node.has_last && dt > 0) {
+      const NumaStat &last = node.last;
+      double hit = counter_delta(cur.numa_hit, last.numa_hit);
+      double miss = counter_delta(cur.numa_miss, last.numa_miss);
+      double local = counter_delta(cur.local_node, last.local_node);
+      double other = counter_delta(cur.other_node, last.other_node);
+      numa_msg->set_numa_hit(hit / dt);
+      numa_msg->set_numa_miss(miss / dt);
+      numa_msg->set_numa_foreign(
+          counter_delta(cur.numa_foreign, last.numa_foreign) / dt);
+      numa_msg->set_interleave_hit(
+          counter_delta(cur.interleave_hit, last.interleave_hit) / dt);
+      numa_msg->set_local_node(local / dt);
+      numa_msg->set_other_node(other / dt);
+      numa_msg->set_miss_percent(hit + miss > 0 ? miss / (hit + miss) * 100.0
+                                                : 0);
+      numa_msg->set_remote_percent(
+          local + other > 0 ? other / (local + other) * 100.0 : 0);
+    }
+    node.last = cur;
+    node.has_last = true;
+  }
+}
+
+void NumaMonitor::Stop() {
+  for (auto &node : nodes_) {
+    if (node.meminfo_fd >= 0)
+      close(node.meminfo_fd);
+    if (node.numastat_fd >= 0)
+      close(node.numastat_fd);
+  }
+  nodes_.clear();
+}
+} // namespace yanhon
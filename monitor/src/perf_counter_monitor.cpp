@@ -0,0 +1,206 @@
+#include "monitor/perf_counter_monitor.hpp"
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace yanhon {
+struct PerfEventDesc {
+  uint32_t type;
+  uint64_t config;
+  PerfCounter counter;
+};
+
+// 顺序即组内顺序：硬件事件在前，第一个成功打开的事件担任组长
+static const PerfEventDesc kPerfEvents[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, kCycles},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, kInstructions},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, kLlcMisses},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, kBranchMisses},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, kContextSwitches},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, kCpuMigrations},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, kPageFaults},
+};
+
+static int perf_event_open(const PerfEventDesc &desc, int cpu, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = desc.type;
+  attr.config = desc.config;
+  // 组长先保持关闭，整组建好后一次性开启，保证组内计数时间窗口一致
+  attr.disabled = group_fd < 0;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(__NR_perf_event_open, &attr, -1, cpu, group_fd,
+                 PERF_FLAG_FD_CLOEXEC);
+}
+
+static const PerfEventDesc &find_desc(PerfCounter counter) {
+  for (const auto &desc : kPerfEvents) {
+    if (desc.counter == counter) {
+      return desc;
+    }
+  }
+  return kPerfEvents[0];
+}
+
+PerfCounterMonitor::PerfCounterMonitor(bool emit_per_cpu)
+    : emit_per_cpu_(emit_per_cpu) {
+  long ncpu = sysconf(_SC_NPROCESSORS_CONF);
+  for (int cpu = 0; cpu < ncpu; ++cpu) {
+    CpuGroup group;
+    group.cpu = cpu;
+    if (OpenGroup(cpu, &group)) {
+      groups_.push_back(std::move(group));
+    }
+  }
+  if (groups_.empty()) {
+    std::cerr << "perf_event_open failed on all CPUs: " << strerror(errno)
+              << std::endl;
+    return;
+  }
+  // 读取格式：nr, time_enabled, time_running, values[nr]
+  read_buf_.resize(3 + layout_.size());
+  last_time_ = std::chrono::steady_clock::now();
+}
+
+PerfCounterMonitor::~PerfCounterMonitor() { Stop(); }
+
+/**
+ * @brief 在 cpu 上打开一个事件组
+ * 第一次调用时逐个探测事件，打不开的事件（PMU 不支持或虚拟机没有 PMU）
+ * 从组布局中去掉；之后的 CPU 按相同布局打开，任一事件失败则跳过该 CPU
+ */
+bool PerfCounterMonitor::OpenGroup(int cpu, CpuGroup *group) {
+  bool probing = layout_.empty();
+  if (probing) {
+    for (const auto &desc : kPerfEvents) {
+      int leader = group->fds.empty() ? -1 : group->fds[0];
+      int fd = perf_event_open(desc, cpu, leader);
+      if (fd < 0) {
+        continue;
+      }
+      group->fds.push_back(fd);
+      layout_.push_back(desc.counter);
+      if (desc.type == PERF_TYPE_HARDWARE) {
+        hardware_ = true;
+      }
+    }
+  } else {
+    for (PerfCounter counter : layout_) {
+      int leader = group->fds.empty() ? -1 : group->fds[0];
+      int fd = perf_event_open(find_desc(counter), cpu, leader);
+      if (fd < 0) {
+        // 离线 CPU 返回 ENODEV
+        break;
+      }
+      group->fds.push_back(fd);
+    }
+  }
+
+  if (group->fds.empty() || group->fds.size() != layout_.size()) {
+    for (int fd : group->fds) {
+      close(fd);
+    }
+    group->fds.clear();
+    return false;
+  }
+  ioctl(group->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+static void fill_counter(monitor::proto::PerfCpuCounter *msg,
+                         const double *rate, float running_percent) {
+  msg->set_cycles(rate[kCycles]);
+  msg->set_instructions(rate[kInstructions]);
+  msg->set_llc_misses(rate[kLlcMisses]);
+  msg->set_branch_misses(rate[kBranchMisses]);
+  if (rate[kCycles] > 0) {
+    msg->set_ipc(rate[kInstructions] / rate[kCycles]);
+  }
+  if (rate[kInstructions] > 0) {
+    msg->set_llc_mpki(rate[kLlcMisses] * 1000 / rate[kInstructions]);
+    msg->set_branch_mpki(rate[kBranchMisses] * 1000 / rate[kInstructions]);
+  }
+  msg->set_context_switches(rate[kContextSwitches]);
+  msg->set_cpu_migrations(rate[kCpuMigrations]);
+  msg->set_page_faults(rate[kPageFaults]);
+  msg->set_running_percent(running_percent);
+}
+
+void PerfCounterMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (groups_.empty()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+  last_time_ = now;
+
+  auto perf_msg = monitor_info->mutable_perf_counter_info();
+  perf_msg->set_hardware(hardware_);
+
+  double total[kPerfCounterCount] = {};
+  double running_sum = 0;
+  int reported = 0;
+  size_t nr = layout_.size();
+  size_t read_size = read_buf_.size() * sizeof(uint64_t);
+  for (auto &group : groups_) {
+    if (read(group.fds[0], read_buf_.data(), read_size) !=
+            static_cast<ssize_t>(read_size) ||
+        read_buf_[0] != nr) {
+      continue;
+    }
+    uint64_t enabled = read_buf_[1];
+    uint64_t running = read_buf_[2];
+    const uint64_t *values = &read_buf_[3];
+
+    if (group.has_last && dt > 0) {
+      uint64_t d_enabled = enabled - group.last_enabled;
+      uint64_t d_running = running - group.last_running;
+      // 计数器数量不足时内核会轮流调度事件组，按运行时间比例放大
+      double scale = d_running > 0 ? double(d_enabled) / d_running : 0;
+      double rate[kPerfCounterCount] = {};
+      for (size_t i = 0; i < nr; ++i) {
+        PerfCounter counter = layout_[i];
+        rate[counter] = (values[i] - group.last[counter]) * scale / dt;
+        total[counter] += rate[counter];
+      }
+      float running_percent =
+          d_enabled > 0 ? d_running * 100.0 / d_enabled : 0;
+      running_sum += running_percent;
+      ++reported;
+      if (emit_per_cpu_) {
+        auto cpu_msg = perf_msg->add_cpus();
+        cpu_msg->set_cpu(group.cpu);
+        fill_counter(cpu_msg, rate, running_percent);
+      }
+    }
+
+    for (size_t i = 0; i < nr; ++i) {
+      group.last[layout_[i]] = values[i];
+    }
+    group.last_enabled = enabled;
+    group.last_running = running;
+    group.has_last = true;
+  }
+
+  if (reported > 0) {
+    auto total_msg = perf_msg->mutable_total();
+    total_msg->set_cpu(-1);
+    fill_counter(total_msg, total, running_sum / reported);
+  }
+}
+
+void PerfCounterMonitor::Stop() {
+  for (auto &group : groups_) {
+    for (int fd : group.fds) {
+      close(fd);
+    }
+  }
+  groups_.clear();
+}
+} // namespace yanhon
@@ -0,0 +1,197 @@
+#include "monitor/pressure_monitor.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace yanhon {
+static const char *kPressureResources[] = {"cpu", "memory", "io"};
+
+const char *ParsePsiLine(const char *p, const char *end, const char *kind,
+                         PsiLine *out) {
+  size_t kind_len = strlen(kind);
+  if (end - p < (long)kind_len || strncmp(p, kind, kind_len) != 0) {
+    return nullptr;
+  }
+  char *next = nullptr;
+  p = strstr(p, "avg10=");
+  if (!p || p >= end)
+    return nullptr;
+  out->avg10 = strtof(p + 6, &next);
+  p = strstr(next, "avg60=");
+  if (!p || p >= end)
+    return nullptr;
+  out->avg60 = strtof(p + 6, &next);
+  p = strstr(next, "avg300=");
+  if (!p || p >= end)
+    return nullptr;
+  out->avg300 = strtof(p + 7, &next);
+  p = strstr(next, "total=");
+  if (!p || p >= end)
+    return nullptr;
+  out->total = strtoull(p + 6, &next, 10);
+  const char *nl = static_cast<const char *>(memchr(next, '\n', end - next));
+  return nl ? nl + 1 : end;
+}
+
+static void fill_pressure_stat(monitor::proto::PressureStat *msg,
+                               const PsiLine &cur, const PsiLine &last,
+                               bool has_last, double dt_us) {
+  msg->set_avg10(cur.avg10);
+  msg->set_avg60(cur.avg60);
+  msg->set_avg300(cur.avg300);
+  msg->set_total(cur.total);
+  if (has_last && dt_us > 0 && cur.total >= last.total) {
+    msg->set_stall_percent((cur.total - last.total) / dt_us * 100.0);
+  } else {
+    msg->set_stall_percent(0);
+  }
+}
+
+PressureMonitor::PressureMonitor(uint32_t stall_threshold_us,
+                                 uint32_t window_us)
+    : stall_threshold_us_(stall_threshold_us), window_us_(window_us) {
+  for (const char *name : kPressureResources) {
+    std::string path = std::string("/proc/pressure/") + name;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      // 内核未开启 CONFIG_PSI 或启动参数 psi=0
+      continue;
+    }
+    Resource res;
+    res.name = name;
+    res.fd = fd;
+    res.trigger_fd = RegisterTrigger(path, "some");
+    resources_.push_back(res);
+  }
+  if (resources_.empty()) {
+    std::cerr << "PSI not available, /proc/pressure missing" << std::endl;
+  }
+}
+
+PressureMonitor::~PressureMonitor() { Stop(); }
+
+/**
+ * @brief 向 PSI 文件写入 "<some|full> <阈值us> <窗口us>" 注册触发器
+ * @return 成功返回可 poll 的 fd，失败返回 -1（通常是权限不足）
+ */
+int PressureMonitor::RegisterTrigger(const std::string &path,
+                                     const char *kind) {
+  int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  char trigger[64];
+  int len = snprintf(trigger, sizeof(trigger), "%s %u %u", kind,
+                     stall_threshold_us_, window_us_);
+  // 内核要求写入内容包含结尾的 '\0'
+  if (write(fd, trigger, len + 1) < 0) {
+    std::cerr << "Failed to register PSI trigger on " << path << ": "
+              << strerror(errno) << std::endl;
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool PressureMonitor::WaitForStall(std::chrono::milliseconds timeout) {
+  struct pollfd fds[3];
+  size_t owners[3];
+  nfds_t nfds = 0;
+  for (size_t i = 0; i < resources_.size(); ++i) {
+    if (resources_[i].trigger_fd < 0)
+      continue;
+    fds[nfds].fd = resources_[i].trigger_fd;
+    fds[nfds].events = POLLPRI;
+    fds[nfds].revents = 0;
+    owners[nfds] = i;
+    ++nfds;
+  }
+
+  int ret = poll(fds, nfds, timeout.count());
+  if (ret <= 0) {
+    // 超时，或 EINTR 等错误，交给调用方按原周期继续
+    return false;
+  }
+
+  bool fired = false;
+  for (nfds_t i = 0; i < nfds; ++i) {
+    Resource &res = resources_[owners[i]];
+    if (fds[i].revents & POLLERR) {
+      // 触发器所在的文件已失效，关闭后退化为普通轮询
+      close(res.trigger_fd);
+      res.trigger_fd = -1;
+      continue;
+    }
+    if (fds[i].revents & POLLPRI) {
+      res.triggered = true;
+      fired = true;
+    }
+  }
+  triggered_ = triggered_ || fired;
+  return fired;
+}
+
+void PressureMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (resources_.empty()) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  auto pressure_msg = monitor_info->mutable_pressure_info();
+  pressure_msg->set_triggered(triggered_);
+
+  char buf[256];
+  for (auto &res : resources_) {
+    ssize_t n = pread(res.fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+      continue;
+    }
+    buf[n] = '\0';
+    const char *end = buf + n;
+
+    PsiLine some{}, full{};
+    const char *p = ParsePsiLine(buf, end, "some", &some);
+    if (!p) {
+      continue;
+    }
+    // 旧内核的 cpu 文件只有 some 一行
+    res.has_full = ParsePsiLine(p, end, "full", &full) != nullptr;
+
+    double dt_us =
+        std::chrono::duration<double, std::micro>(now - res.last_time).count();
+    auto res_msg = pressure_msg->add_resources();
+    res_msg->set_resource(res.name);
+    res_msg->set_triggered(res.triggered);
+    fill_pressure_stat(res_msg->mutable_some(), some, res.last_some,
+                       res.has_last, dt_us);
+    if (res.has_full) {
+      fill_pressure_stat(res_msg->mutable_full(), full, res.last_full,
+                         res.has_last, dt_us);
+    }
+
+    res.last_some = some;
+    res.last_full = full;
+    res.last_time = now;
+    res.has_last = true;
+    res.triggered = false;
+  }
+  triggered_ = false;
+}
+
+void PressureMonitor::Stop() {
+  for (auto &res : resources_) {
+    if (res.trigger_fd >= 0) {
+      close(res.trigger_fd);
+      res.trigger_fd = -1;
+    }
+    if (res.fd >= 0) {
+      close(res.fd);
+      res.fd = -1;
+    }
+  }
+  resources_.clear();
+}
+} // namespace yanhon
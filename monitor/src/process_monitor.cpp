@@ -0,0 +1,582 @@
+#include "monitor/process_monitor.hpp"
+#include "proc_cpu.skel.h"
+#include <algorithm>
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <iostream>
+#include <unordered_map>
+
+namespace yanhon {
+static constexpr float BToMB = 1024 * 1024;
+static constexpr size_t kBpfBatch = 1024;
+// 片段切出后其全长在这么多次采集内仍未出现在 Map 中（进程已退出或被
+// LRU 淘汰）时放弃扣除
+static constexpr uint32_t kDebtMaxAge = 2;
+
+struct linux_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+static inline size_t hash_pid(int32_t pid, size_t mask) {
+  return (static_cast<uint32_t>(pid) * 2654435761u) & mask;
+}
+
+PidTable::PidTable(size_t capacity) {
+  size_t cap = 16;
+  while (cap < capacity)
+    cap <<= 1;
+  slots_.assign(cap, ProcSlot{});
+}
+
+ProcSlot *PidTable::FindOrInsert(int32_t pid, bool *inserted) {
+  // 负载因子（含墓碑）保持在 1/2 以下，保证探测链足够短
+  if ((size_ + tombstones_ + 1) * 2 > slots_.size()) {
+    Rehash(size_ * 4 > slots_.size() ? slots_.size() * 2 : slots_.size());
+  }
+  size_t mask = slots_.size() - 1;
+  size_t i = hash_pid(pid, mask);
+  ProcSlot *tomb = nullptr;
+  while (true) {
+    ProcSlot &slot = slots_[i];
+    if (slot.pid == pid) {
+      *inserted = false;
+      return &slot;
+    }
+    if (slot.pid == 0) {
+      ProcSlot *dst = tomb ? tomb : &slot;
+      if (tomb)
+        --tombstones_;
+      *dst = ProcSlot{};
+      dst->pid = pid;
+      ++size_;
+      *inserted = true;
+      return dst;
+    }
+    if (slot.pid == -1 && !tomb) {
+      tomb = &slot;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+void PidTable::Sweep(uint32_t tick) {
+  for (auto &slot : slots_) {
+    if (slot.pid > 0 && slot.seen_tick != tick) {
+      slot.pid = -1;
+      --size_;
+      ++tombstones_;
+    }
+  }
+  if (tombstones_ * 4 > slots_.size()) {
+    Rehash(slots_.size());
+  }
+}
+
+void PidTable::Rehash(size_t capacity) {
+  std::vector<ProcSlot> old;
+  old.swap(slots_);
+  slots_.assign(capacity, ProcSlot{});
+  size_ = 0;
+  tombstones_ = 0;
+  size_t mask = capacity - 1;
+  for (const auto &slot : old) {
+    if (slot.pid <= 0)
+      continue;
+    size_t i = hash_pid(slot.pid, mask);
+    while (slots_[i].pid != 0)
+      i = (i + 1) & mask;
+    slots_[i] = slot;
+    ++size_;
+  }
+}
+
+/**
+ * @brief 读取 dir_fd 下的相对路径文件，内容以 '\0' 结尾
+ */
+static ssize_t read_at(int dir_fd, const char *path, char *buf, size_t size) {
+  int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t n = read(fd, buf, size - 1);
+  close(fd);
+  if (n < 0) {
+    return -1;
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+static inline uint64_t parse_u64(const char *&p) {
+  uint64_t v = 0;
+  while (*p >= '0' && *p <= '9') {
+    v = v * 10 + (*p - '0');
+    ++p;
+  }
+  return v;
+}
+
+/** @brief 本周期读写速率，用于 I/O 排序 */
+static inline float io_rate(const ProcSlot *slot) {
+  return slot->io_dt > 0 ? slot->io_delta / slot->io_dt : 0;
+}
+
+static inline void skip_fields(const char *&p, int count) {
+  while (count-- > 0) {
+    while (*p && *p != ' ')
+      ++p;
+    while (*p == ' ')
+      ++p;
+  }
+}
+
+ProcessMonitor::ProcessMonitor(size_t top_n, uint32_t budget_us,
+                               Source source)
+    : table_(32768), top_n_(top_n), budget_us_(budget_us),
+      clk_tck_(sysconf(_SC_CLK_TCK)), page_size_(sysconf(_SC_PAGESIZE)),
+      dents_buf_(64 * 1024) {
+  last_time_ = std::chrono::steady_clock::now();
+  if (source == Source::kEbpf) {
+    if (LoadBpf()) {
+      return;
+    }
+    std::cerr << "sched_switch BPF unavailable, falling back to /proc scan"
+              << std::endl;
+  }
+  proc_fd_ = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (proc_fd_ < 0) {
+    std::cerr << "Failed to open /proc: " << strerror(errno) << std::endl;
+  }
+}
+
+bool ProcessMonitor::LoadBpf() {
+  skel_ = proc_cpu_bpf__open_and_load();
+  if (!skel_) {
+    return false;
+  }
+  if (proc_cpu_bpf__attach(skel_) != 0) {
+    proc_cpu_bpf__destroy(skel_);
+    skel_ = nullptr;
+    return false;
+  }
+  int ncpus = libbpf_num_possible_cpus();
+  if (ncpus <= 0) {
+    proc_cpu_bpf__destroy(skel_);
+    skel_ = nullptr;
+    return false;
+  }
+  bpf_keys_.resize(kBpfBatch);
+  bpf_vals_.resize(kBpfBatch);
+  slot_vals_.resize(ncpus);
+  running_.resize(ncpus);
+  return true;
+}
+
+/**
+ * @brief 把各 CPU 上尚未切出的运行片段计入本周期
+ * sched_switch 只在切出时记账，独占 CPU 的进程在切出前一直为 0，切出时
+ * 整段积压落在一个周期内。采集时按 switch_start 中的开始时间计入已运行
+ * 的部分并记住已计入的量；片段切出后 Map 中的值包含其全长，已计入的部分
+ * 作为欠账从该 tgid 之后取走的值中扣除
+ */
+void ProcessMonitor::CreditRunning(
+    std::vector<std::pair<uint32_t, proc_cpu_val>> *drained) {
+  uint32_t zero = 0;
+  int slot_fd = bpf_map__fd(skel_->maps.switch_start);
+  if (bpf_map_lookup_elem(slot_fd, &zero, slot_vals_.data()) != 0) {
+    return;
+  }
+  // 与 bpf_ktime_get_ns 相同的时钟
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t now = ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+  for (size_t cpu = 0; cpu < running_.size(); ++cpu) {
+    RunningSlice &run = running_[cpu];
+    const proc_cpu_slot &slot = slot_vals_[cpu];
+    if (run.tgid != 0 && run.start != slot.start) {
+      debts_[run.tgid].ns += run.credited;
+      run = {};
+    }
+  }
+
+  std::unordered_map<uint32_t, size_t> index;
+  index.reserve(drained->size());
+  for (size_t i = 0; i < drained->size(); ++i) {
+    auto &[tgid, val] = (*drained)[i];
+    index.emplace(tgid, i);
+    auto it = debts_.find(tgid);
+    if (it != debts_.end()) {
+      uint64_t paid = std::min<uint64_t>(it->second.ns, val.on_cpu_ns);
+      val.on_cpu_ns -= paid;
+      it->second.ns -= paid;
+    }
+  }
+  for (auto it = debts_.begin(); it != debts_.end();) {
+    if (it->second.ns == 0 || ++it->second.age > kDebtMaxAge) {
+      it = debts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (size_t cpu = 0; cpu < running_.size(); ++cpu) {
+    RunningSlice &run = running_[cpu];
+    const proc_cpu_slot &slot = slot_vals_[cpu];
+    if (slot.start == 0 || slot.tgid == 0 || now <= slot.start) {
+      continue;
+    }
+    if (run.start != slot.start) {
+      run = {slot.start, slot.tgid, 0};
+    }
+    uint64_t ran = now - slot.start;
+    if (ran <= run.credited) {
+      continue;
+    }
+    auto [it, inserted] = index.emplace(slot.tgid, drained->size());
+    if (inserted) {
+      drained->emplace_back(slot.tgid, proc_cpu_val{});
+    }
+    (*drained)[it->second].second.on_cpu_ns += ran - run.credited;
+    run.credited = ran;
+  }
+}
+
+/**
+ * @brief 读取 /proc/[tgid]/comm
+ * 运行片段尚未切出过的 tgid 在 Map 中没有记录，进程名需要补读
+ */
+static void read_comm(uint32_t tgid, char *comm, size_t size) {
+  char path[32];
+  snprintf(path, sizeof(path), "/proc/%u/comm", tgid);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  ssize_t n = read(fd, comm, size);
+  close(fd);
+  if (n > 0 && comm[n - 1] == '\n') {
+    comm[n - 1] = '\0';
+  }
+}
+
+/**
+ * @brief 取走并清空 tgid_cpu 中自上次采集以来的累计值
+ * 优先使用批量 lookup_and_delete，旧内核或批量操作中途出错时退化为
+ * 逐个遍历删除
+ */
+void ProcessMonitor::UpdateFromBpf(monitor::proto::MonitorInfo *monitor_info) {
+  auto start = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(start - last_time_).count();
+  last_time_ = start;
+
+  int map_fd = bpf_map__fd(skel_->maps.tgid_cpu);
+  std::vector<std::pair<uint32_t, proc_cpu_val>> drained;
+
+  uint32_t out_batch = 0;
+  bool first = true;
+  bool batch_ok = true;
+  while (true) {
+    uint32_t in_batch = out_batch;
+    uint32_t count = kBpfBatch;
+    int err = bpf_map_lookup_and_delete_batch(
+        map_fd, first ? nullptr : &in_batch, &out_batch, bpf_keys_.data(),
+        bpf_vals_.data(), &count, nullptr);
+    first = false;
+    for (uint32_t i = 0; i < count; ++i) {
+      drained.emplace_back(bpf_keys_[i], bpf_vals_[i]);
+    }
+    if (err == 0) {
+      continue;
+    }
+    // 即使已经取出部分项，剩余的项也要逐个取完，否则会被计入下个周期
+    if (err != -ENOENT) {
+      batch_ok = false;
+    }
+    break;
+  }
+
+  if (!batch_ok) {
+    // 删除当前 key 后无法继续 get_next_key，因此每次都从头取第一个
+    uint32_t key;
+    proc_cpu_val val;
+    while (bpf_map_get_next_key(map_fd, nullptr, &key) == 0) {
+      if (bpf_map_lookup_elem(map_fd, &key, &val) != 0 ||
+          bpf_map_delete_elem(map_fd, &key) != 0) {
+        break;
+      }
+      drained.emplace_back(key, val);
+    }
+  }
+
+  CreditRunning(&drained);
+
+  auto *process_msg = monitor_info->mutable_process_info();
+  process_msg->set_total_pids(drained.size());
+
+  size_t n = std::min(top_n_, drained.size());
+  std::partial_sort(drained.begin(), drained.begin() + n, drained.end(),
+                    [](const auto &a, const auto &b) {
+                      return a.second.on_cpu_ns > b.second.on_cpu_ns;
+                    });
+  for (size_t i = 0; i < n; ++i) {
+    auto *msg = process_msg->add_top_cpu();
+    msg->set_pid(drained[i].first);
+    char comm[sizeof(drained[i].second.comm) + 1] = {};
+    memcpy(comm, drained[i].second.comm, sizeof(drained[i].second.comm));
+    if (comm[0] == '\0') {
+      read_comm(drained[i].first, comm, sizeof(drained[i].second.comm));
+    }
+    msg->set_comm(comm);
+    if (dt > 0) {
+      msg->set_cpu_percent(drained[i].second.on_cpu_ns / 1e9 / dt * 100.0);
+    }
+  }
+
+  process_msg->set_scan_cost_ms(
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+}
+
+ProcessMonitor::~ProcessMonitor() { Stop(); }
+
+/**
+ * @brief 解析 /proc/[pid]/stat，comm 可能包含空格与括号，
+ * 因此从最后一个 ')' 之后开始按字段计数
+ */
+bool ProcessMonitor::ReadStat(int32_t pid, ProcSlot *slot, bool inserted) {
+  char path[32];
+  char buf[1024];
+  snprintf(path, sizeof(path), "%d/stat", pid);
+  ssize_t n = read_at(proc_fd_, path, buf, sizeof(buf));
+  if (n <= 0) {
+    return false;
+  }
+  const char *lparen = static_cast<const char *>(memchr(buf, '(', n));
+  const char *rparen = static_cast<const char *>(memrchr(buf, ')', n));
+  if (!lparen || !rparen || rparen < lparen) {
+    return false;
+  }
+
+  // 字段从 3（state）开始
+  const char *p = rparen + 2;
+  skip_fields(p, 11); // 跳到字段 14 utime
+  uint64_t utime = parse_u64(p);
+  skip_fields(p, 1);
+  uint64_t stime = parse_u64(p);
+  skip_fields(p, 5); // 字段 20 num_threads
+  uint32_t num_threads = parse_u64(p);
+  skip_fields(p, 2); // 字段 22 starttime
+  uint64_t start_time = parse_u64(p);
+  skip_fields(p, 2); // 字段 24 rss
+  uint64_t rss_pages = parse_u64(p);
+
+  uint64_t cpu_ticks = utime + stime;
+  if (inserted || slot->start_time != start_time) {
+    // 新进程或 pid 被复用，重新建立基线
+    int32_t saved_pid = slot->pid;
+    *slot = ProcSlot{};
+    slot->pid = saved_pid;
+    slot->start_time = start_time;
+    slot->cpu_ticks = cpu_ticks;
+    slot->cpu_delta = 0;
+  } else {
+    slot->cpu_delta = static_cast<uint32_t>(cpu_ticks - slot->cpu_ticks);
+    slot->cpu_ticks = cpu_ticks;
+  }
+  size_t comm_len =
+      std::min<size_t>(rparen - lparen - 1, sizeof(slot->comm) - 1);
+  memcpy(slot->comm, lparen + 1, comm_len);
+  slot->comm[comm_len] = '\0';
+  slot->num_threads = num_threads;
+  slot->rss_pages = rss_pages;
+  return true;
+}
+
+void ProcessMonitor::ReadIo(int32_t pid, ProcSlot *slot, int64_t now_ns) {
+  char path[32];
+  char buf[512];
+  snprintf(path, sizeof(path), "%d/io", pid);
+  // 读取其他用户的进程需要 CAP_SYS_PTRACE，失败时保持上次的值
+  if (read_at(proc_fd_, path, buf, sizeof(buf)) <= 0) {
+    return;
+  }
+  const char *rb = strstr(buf, "\nread_bytes: ");
+  const char *wb = strstr(buf, "\nwrite_bytes: ");
+  if (!rb || !wb) {
+    return;
+  }
+  rb += 13;
+  wb += 14;
+  uint64_t read_bytes = parse_u64(rb);
+  uint64_t write_bytes = parse_u64(wb);
+  // 跳过读取的周期不更新基线，增量按上次读取至今的时长计算速率
+  if (slot->has_io && read_bytes >= slot->read_bytes &&
+      write_bytes >= slot->write_bytes && now_ns > slot->io_time_ns) {
+    slot->read_delta = read_bytes - slot->read_bytes;
+    slot->write_delta = write_bytes - slot->write_bytes;
+    slot->io_delta = slot->read_delta + slot->write_delta;
+    slot->io_dt = (now_ns - slot->io_time_ns) / 1e9;
+  }
+  slot->read_bytes = read_bytes;
+  slot->write_bytes = write_bytes;
+  slot->io_time_ns = now_ns;
+  slot->has_io = true;
+}
+
+void ProcessMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (skel_) {
+    UpdateFromBpf(monitor_info);
+    return;
+  }
+  if (proc_fd_ < 0) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(start - last_time_).count();
+  last_time_ = start;
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       start.time_since_epoch())
+                       .count();
+  ++tick_;
+
+  bool budget_exceeded = false;
+  uint32_t scanned = 0;
+
+  lseek(proc_fd_, 0, SEEK_SET);
+  while (true) {
+    long nread = syscall(SYS_getdents64, proc_fd_, dents_buf_.data(),
+                         dents_buf_.size());
+    if (nread <= 0) {
+      break;
+    }
+    for (long off = 0; off < nread;) {
+      auto *de = reinterpret_cast<linux_dirent64 *>(dents_buf_.data() + off);
+      off += de->d_reclen;
+      const char *name = de->d_name;
+      if (*name < '1' || *name > '9') {
+        continue;
+      }
+      int32_t pid = static_cast<int32_t>(parse_u64(name));
+      if (*name != '\0') {
+        continue;
+      }
+
+      bool inserted = false;
+      ProcSlot *slot = table_.FindOrInsert(pid, &inserted);
+      if (!ReadStat(pid, slot, inserted)) {
+        // 进程在枚举与读取之间退出，留给 Sweep 清理
+        continue;
+      }
+      slot->seen_tick = tick_;
+      slot->read_delta = slot->write_delta = slot->io_delta = 0;
+      slot->io_dt = 0;
+      ++scanned;
+
+      // 定期检查耗时，超出预算后跳过 I/O 统计，只保证 CPU 与 RSS
+      if ((scanned & 255) == 0 && !budget_exceeded) {
+        auto cost = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        budget_exceeded = cost > budget_us_;
+      }
+      // CPU 时间没有变化的进程不可能产生新的 I/O，跳过 io 文件
+      if (!budget_exceeded && (inserted || slot->cpu_delta > 0)) {
+        ReadIo(pid, slot, now_ns);
+      }
+    }
+  }
+
+  // 插入过程中表可能扩容，扫描结束后再收集本轮存活的槽位
+  std::vector<ProcSlot *> active;
+  active.reserve(table_.size());
+  for (auto &slot : table_.slots()) {
+    if (slot.pid > 0 && slot.seen_tick == tick_ && slot.rss_pages > 0) {
+      active.push_back(&slot);
+    }
+  }
+
+  auto *process_msg = monitor_info->mutable_process_info();
+  process_msg->set_total_pids(scanned);
+  process_msg->set_budget_exceeded(budget_exceeded);
+
+  size_t n = std::min(top_n_, active.size());
+  auto fill = [&](monitor::proto::ProcessStat *msg, const ProcSlot *slot) {
+    msg->set_pid(slot->pid);
+    msg->set_comm(slot->comm);
+    msg->set_num_threads(slot->num_threads);
+    msg->set_rss(slot->rss_pages * page_size_ / BToMB);
+    if (dt > 0) {
+      msg->set_cpu_percent(slot->cpu_delta * 100.0 / clk_tck_ / dt);
+    }
+    if (slot->io_dt > 0) {
+      msg->set_read_bytes_per_sec(slot->read_delta / slot->io_dt);
+      msg->set_write_bytes_per_sec(slot->write_delta / slot->io_dt);
+    }
+  };
+
+  std::partial_sort(active.begin(), active.begin() + n, active.end(),
+                    [](const ProcSlot *a, const ProcSlot *b) {
+                      return a->cpu_delta > b->cpu_delta;
+                    });
+  for (size_t i = 0; i < n && active[i]->cpu_delta > 0; ++i) {
+    fill(process_msg->add_top_cpu(), active[i]);
+  }
+
+  std::partial_sort(active.begin(), active.begin() + n, active.end(),
+                    [](const ProcSlot *a, const ProcSlot *b) {
+                      return a->rss_pages > b->rss_pages;
+                    });
+  for (size_t i = 0; i < n; ++i) {
+    auto *msg = process_msg->add_top_rss();
+    fill(msg, active[i]);
+    // statm 第三个字段为共享页数，只对 Top-N 读取
+    char path[32];
+    char buf[128];
+    snprintf(path, sizeof(path), "%d/statm", active[i]->pid);
+    if (read_at(proc_fd_, path, buf, sizeof(buf)) > 0) {
+      const char *p = buf;
+      skip_fields(p, 2);
+      msg->set_shared(parse_u64(p) * page_size_ / BToMB);
+    }
+  }
+
+  std::partial_sort(active.begin(), active.begin() + n, active.end(),
+                    [](const ProcSlot *a, const ProcSlot *b) {
+                      return io_rate(a) > io_rate(b);
+                    });
+  for (size_t i = 0; i < n && active[i]->io_delta > 0; ++i) {
+    fill(process_msg->add_top_io(), active[i]);
+  }
+
+  // Sweep 可能触发 Rehash，active 中的指针在此之后失效
+  table_.Sweep(tick_);
+
+  process_msg->set_scan_cost_ms(
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+}
+
+void ProcessMonitor::Stop() {
+  if (skel_) {
+    proc_cpu_bpf__destroy(skel_);
+    skel_ = nullptr;
+  }
+  if (proc_fd_ >= 0) {
+    close(proc_fd_);
+    proc_fd_ = -1;
+  }
+}
+} // namespace yanhon
@@ -0,0 +1,295 @@
+#include "monitor/proto_stats_monitor.hpp"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace yanhon {
+struct ProtoStatKey {
+  const char *prefix;
+  const char *name;
+  ProtoStatField field;
+};
+
+static const ProtoStatKey kProtoStatKeys[] = {
+    {"Ip:", "InDiscards", kIpInDiscards},
+    {"Ip:", "OutDiscards", kIpOutDiscards},
+    {"Ip:", "OutNoRoutes", kIpOutNoRoutes},
+    {"Ip:", "ReasmFails", kIpReasmFails},
+    {"Tcp:", "ActiveOpens", kTcpActiveOpens},
+    {"Tcp:", "PassiveOpens", kTcpPassiveOpens},
+    {"Tcp:", "AttemptFails", kTcpAttemptFails},
+    {"Tcp:", "EstabResets", kTcpEstabResets},
+    {"Tcp:", "CurrEstab", kTcpCurrEstab},
+    {"Tcp:", "InSegs", kTcpInSegs},
+    {"Tcp:", "OutSegs", kTcpOutSegs},
+    {"Tcp:", "RetransSegs", kTcpRetransSegs},
+    {"Tcp:", "InErrs", kTcpInErrs},
+    {"Tcp:", "OutRsts", kTcpOutRsts},
+    {"Tcp:", "InCsumErrors", kTcpInCsumErrors},
+    {"Udp:", "InDatagrams", kUdpInDatagrams},
+    {"Udp:", "OutDatagrams", kUdpOutDatagrams},
+    {"Udp:", "NoPorts", kUdpNoPorts},
+    {"Udp:", "InErrors", kUdpInErrors},
+    {"Udp:", "RcvbufErrors", kUdpRcvbufErrors},
+    {"Udp:", "SndbufErrors", kUdpSndbufErrors},
+    {"Udp:", "InCsumErrors", kUdpInCsumErrors},
+    {"Udp:", "MemErrors", kUdpMemErrors},
+    {"TcpExt:", "ListenOverflows", kListenOverflows},
+    {"TcpExt:", "ListenDrops", kListenDrops},
+    {"TcpExt:", "TCPBacklogDrop", kTcpBacklogDrop},
+    {"TcpExt:", "TCPReqQFullDrop", kTcpReqQFullDrop},
+    {"TcpExt:", "SyncookiesSent", kSyncookiesSent},
+    {"TcpExt:", "TCPTimeouts", kTcpTimeouts},
+    {"TcpExt:", "TCPSynRetrans", kTcpSynRetrans},
+    {"TcpExt:", "TCPFastRetrans", kTcpFastRetrans},
+    {"TcpExt:", "TCPLostRetransmit", kTcpLostRetransmit},
+    {"TcpExt:", "TCPAbortOnMemory", kTcpAbortOnMemory},
+    {"TcpExt:", "TCPAbortOnTimeout", kTcpAbortOnTimeout},
+    {"TcpExt:", "TCPMemoryPressures", kTcpMemoryPressures},
+    {"TcpExt:", "TCPRcvQDrop", kTcpRcvQDrop},
+    {"TcpExt:", "TCPZeroWindowDrop", kTcpZeroWindowDrop},
+    {"TcpExt:", "PruneCalled", kPruneCalled},
+    {"TcpExt:", "TW", kTw},
+};
+
+static int16_t lookup_field(const std::string &prefix, const char *key,
+                            size_t len) {
+  for (const auto &k : kProtoStatKeys) {
+    if (prefix == k.prefix && strlen(k.name) == len &&
+        memcmp(k.name, key, len) == 0) {
+      return k.field;
+    }
+  }
+  return -1;
+}
+
+static const char *line_end(const char *p, const char *end) {
+  const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+  return nl ? nl : end;
+}
+
+/**
+ * @brief 由表头行建立列映射
+ */
+static void build_index(const char *p, const char *end,
+                        std::vector<SnmpPairIndex> *index) {
+  index->clear();
+  while (p < end) {
+    const char *header_end = line_end(p, end);
+    const char *colon =
+        static_cast<const char *>(memchr(p, ':', header_end - p));
+    if (!colon || header_end == end) {
+      break;
+    }
+    SnmpPairIndex pair;
+    pair.prefix.assign(p, colon + 1 - p);
+    for (const char *k = colon + 1; k < header_end;) {
+      while (k < header_end && *k == ' ') {
+        ++k;
+      }
+      const char *k_end = k;
+      while (k_end < header_end && *k_end != ' ') {
+        ++k_end;
+      }
+      if (k_end > k) {
+        pair.column_field.push_back(lookup_field(pair.prefix, k, k_end - k));
+      }
+      k = k_end;
+    }
+    index->push_back(std::move(pair));
+    // 跳过数值行
+    p = line_end(header_end + 1, end) + 1;
+  }
+}
+
+/**
+ * @brief 按列映射解析数值行，布局与映射不一致时返回 false
+ */
+static bool parse_values(const char *p, const char *end,
+                         const std::vector<SnmpPairIndex> &index,
+                         uint64_t *values) {
+  size_t pair = 0;
+  while (p < end) {
+    const char *header_end = line_end(p, end);
+    if (header_end == end) {
+      break;
+    }
+    if (pair >= index.size()) {
+      return false;
+    }
+    const SnmpPairIndex &idx = index[pair++];
+    const size_t prefix_len = idx.prefix.size();
+    const char *v = header_end + 1;
+    const char *value_end = line_end(v, end);
+    if (value_end - v < static_cast<ptrdiff_t>(prefix_len) ||
+        memcmp(v, idx.prefix.data(), prefix_len) != 0) {
+      return false;
+    }
+    v += prefix_len;
+    size_t col = 0;
+    while (v < value_end) {
+      while (v < value_end && *v == ' ') {
+        ++v;
+      }
+      if (v >= value_end) {
+        break;
+      }
+      // MaxConn 等少数列可能为 -1
+      bool negative = *v == '-';
+      if (negative) {
+        ++v;
+      }
+      uint64_t value = 0;
+      while (v < value_end && *v >= '0' && *v <= '9') {
+        value = value * 10 + (*v - '0');
+        ++v;
+      }
+      if (col >= idx.column_field.size()) {
+        return false;
+      }
+      int16_t field = idx.column_field[col++];
+      if (field >= 0) {
+        values[field] = negative ? 0 : value;
+      }
+      while (v < value_end && *v != ' ') {
+        ++v;
+      }
+    }
+    if (col != idx.column_field.size()) {
+      return false;
+    }
+    p = value_end + 1;
+  }
+  return pair == index.size();
+}
+
+ProtoStatsMonitor::ProtoStatsMonitor() {
+  files_[0].path = "/proc/net/snmp";
+  files_[1].path = "/proc/net/netstat";
+  for (auto &file : files_) {
+    file.buf.resize(8 * 1024);
+    file.fd = open(file.path, O_RDONLY | O_CLOEXEC);
+    if (file.fd < 0) {
+      std::cerr << "Failed to open " << file.path << ": " << strerror(errno)
+                << std::endl;
+    }
+  }
+}
+
+ProtoStatsMonitor::~ProtoStatsMonitor() { Stop(); }
+
+bool ProtoStatsMonitor::ReadFile(ProcFile *file, uint64_t *values) {
+  if (file->fd < 0) {
+    return false;
+  }
+  ssize_t n;
+  while (true) {
+    n = pread(file->fd, file->buf.data(), file->buf.size(), 0);
+    if (n <= 0) {
+      return false;
+    }
+    if (static_cast<size_t>(n) < file->buf.size()) {
+      break;
+    }
+    // 缓冲区被读满，说明内容可能被截断
+    file->buf.resize(file->buf.size() * 2);
+  }
+  const char *begin = file->buf.data();
+  const char *end = begin + n;
+  if (!file->index.empty() &&
+      parse_values(begin, end, file->index, values)) {
+    return true;
+  }
+  // 首次读取，或者列发生变化（例如 IcmpMsg 新出现了类型）
+  build_index(begin, end, &file->index);
+  return parse_values(begin, end, file->index, values);
+}
+
+void ProtoStatsMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  uint64_t cur[kProtoStatFieldCount] = {};
+  // 打开失败的文件始终不参与；已打开的任一文件本次读取失败时跳过这次
+  // 采集，否则它的字段为 0 并进入 last_，下次成功时整段累计值会被当成
+  // 一个周期的增量
+  bool any = false;
+  for (auto &file : files_) {
+    if (file.fd < 0) {
+      continue;
+    }
+    if (!ReadFile(&file, cur)) {
+      return;
+    }
+    any = true;
+  }
+  if (!any) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+
+  if (has_last_ && dt > 0) {
+    double rate[kProtoStatFieldCount];
+    for (int i = 0; i < kProtoStatFieldCount; ++i) {
+      rate[i] = cur[i] >= last_[i] ? (cur[i] - last_[i]) / dt : 0;
+    }
+
+    auto proto_msg = monitor_info->mutable_proto_stats();
+    proto_msg->set_ip_in_discards(rate[kIpInDiscards]);
+    proto_msg->set_ip_out_discards(rate[kIpOutDiscards]);
+    proto_msg->set_ip_out_no_routes(rate[kIpOutNoRoutes]);
+    proto_msg->set_ip_reasm_fails(rate[kIpReasmFails]);
+    proto_msg->set_tcp_active_opens(rate[kTcpActiveOpens]);
+    proto_msg->set_tcp_passive_opens(rate[kTcpPassiveOpens]);
+    proto_msg->set_tcp_attempt_fails(rate[kTcpAttemptFails]);
+    proto_msg->set_tcp_estab_resets(rate[kTcpEstabResets]);
+    proto_msg->set_tcp_curr_estab(cur[kTcpCurrEstab]);
+    proto_msg->set_tcp_in_segs(rate[kTcpInSegs]);
+    proto_msg->set_tcp_out_segs(rate[kTcpOutSegs]);
+    proto_msg->set_tcp_retrans_segs(rate[kTcpRetransSegs]);
+    proto_msg->set_tcp_in_errs(rate[kTcpInErrs]);
+    proto_msg->set_tcp_out_rsts(rate[kTcpOutRsts]);
+    proto_msg->set_tcp_in_csum_errors(rate[kTcpInCsumErrors]);
+    proto_msg->set_tcp_retrans_percent(
+        rate[kTcpOutSegs] > 0
+            ? rate[kTcpRetransSegs] / rate[kTcpOutSegs] * 100.0
+            : 0);
+    proto_msg->set_udp_in_datagrams(rate[kUdpInDatagrams]);
+    proto_msg->set_udp_out_datagrams(rate[kUdpOutDatagrams]);
+    proto_msg->set_udp_no_ports(rate[kUdpNoPorts]);
+    proto_msg->set_udp_in_errors(rate[kUdpInErrors]);
+    proto_msg->set_udp_rcvbuf_errors(rate[kUdpRcvbufErrors]);
+    proto_msg->set_udp_sndbuf_errors(rate[kUdpSndbufErrors]);
+    proto_msg->set_udp_in_csum_errors(rate[kUdpInCsumErrors]);
+    proto_msg->set_udp_mem_errors(rate[kUdpMemErrors]);
+    proto_msg->set_listen_overflows(rate[kListenOverflows]);
+    proto_msg->set_listen_drops(rate[kListenDrops]);
+    proto_msg->set_tcp_backlog_drop(rate[kTcpBacklogDrop]);
+    proto_msg->set_tcp_req_q_full_drop(rate[kTcpReqQFullDrop]);
+    proto_msg->set_syncookies_sent(rate[kSyncookiesSent]);
+    proto_msg->set_tcp_timeouts(rate[kTcpTimeouts]);
+    proto_msg->set_tcp_syn_retrans(rate[kTcpSynRetrans]);
+    proto_msg->set_tcp_fast_retrans(rate[kTcpFastRetrans]);
+    proto_msg->set_tcp_lost_retransmit(rate[kTcpLostRetransmit]);
+    proto_msg->set_tcp_abort_on_memory(rate[kTcpAbortOnMemory]);
+    proto_msg->set_tcp_abort_on_timeout(rate[kTcpAbortOnTimeout]);
+    proto_msg->set_tcp_memory_pressures(rate[kTcpMemoryPressures]);
+    proto_msg->set_tcp_rcv_q_drop(rate[kTcpRcvQDrop]);
+    proto_msg->set_tcp_zero_window_drop(rate[kTcpZeroWindowDrop]);
+    proto_msg->set_prune_called(rate[kPruneCalled]);
+    proto_msg->set_tw(rate[kTw]);
+  }
+
+  memcpy(last_, cur, sizeof(last_));
+  last_time_ = now;
+  has_last_ = true;
+}
+
+void ProtoStatsMonitor::Stop() {
+  for (auto &file : files_) {
+    if (file.fd >= 0) {
+      close(file.fd);
+      file.fd = -1;
+    }
+  }
+}
+} // namespace yanhon
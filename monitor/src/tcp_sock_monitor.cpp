@@ -0,0 +1,242 @@
+#include "monitor/tcp_sock_monitor.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+
+namespace yanhon {
+// 与内核 include/net/tcp_states.h 中的取值一致
+enum {
+  kTcpEstablished = 1,
+  kTcpSynSent,
+  kTcpSynRecv,
+  kTcpFinWait1,
+  kTcpFinWait2,
+  kTcpTimeWait,
+  kTcpClose,
+  kTcpCloseWait,
+  kTcpLastAck,
+  kTcpListen,
+  kTcpClosing,
+};
+
+/** @brief 以 2 为底的对数分桶，0 与 1 落在第 0 个桶 */
+static int log2_bucket(uint32_t v) {
+  int bucket = v > 1 ? 31 - __builtin_clz(v) : 0;
+  return std::min(bucket, TcpSockMonitor::kHistBuckets - 1);
+}
+
+/** @brief 由直方图估算分位数，返回所在桶的上界 */
+static uint32_t hist_percentile(const uint32_t *hist, double p) {
+  uint64_t total = 0;
+  for (int i = 0; i < TcpSockMonitor::kHistBuckets; ++i) {
+    total += hist[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t target = total * p;
+  uint64_t seen = 0;
+  for (int i = 0; i < TcpSockMonitor::kHistBuckets; ++i) {
+    seen += hist[i];
+    if (seen > target) {
+      return (2u << i) - 1;
+    }
+  }
+  return (2u << (TcpSockMonitor::kHistBuckets - 1)) - 1;
+}
+
+TcpSockMonitor::TcpSockMonitor(size_t top_listen)
+    : top_listen_(top_listen), buf_(64 * 1024) {
+  fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+  if (fd_ < 0) {
+    std::cerr << "Failed to open NETLINK_SOCK_DIAG socket: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+TcpSockMonitor::~TcpSockMonitor() { Stop(); }
+
+/**
+ * @brief 处理一条 inet_diag_msg，len 为包含属性在内的负载长度
+ */
+void TcpSockMonitor::Aggregate(const struct inet_diag_msg *msg, int len) {
+  uint8_t state = msg->idiag_state;
+  state_count_[state & 15]++;
+
+  if (state == kTcpListen) {
+    // 监听 socket 的 rqueue/wqueue 为 accept 队列当前长度与上限
+    auto &lq = listen_[ntohs(msg->id.idiag_sport)];
+    lq.sockets++;
+    lq.queue += msg->idiag_rqueue;
+    lq.backlog += msg->idiag_wqueue;
+    return;
+  }
+  recv_queue_bytes_ += msg->idiag_rqueue;
+  send_queue_bytes_ += msg->idiag_wqueue;
+  if (state != kTcpEstablished) {
+    return;
+  }
+
+  int attr_len = len - NLMSG_ALIGN(sizeof(*msg));
+  const struct rtattr *attr = reinterpret_cast<const struct rtattr *>(
+      reinterpret_cast<const char *>(msg) + NLMSG_ALIGN(sizeof(*msg)));
+  for (; RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+    if (attr->rta_type != INET_DIAG_INFO) {
+      continue;
+    }
+    // 不同内核的 tcp_info 长度不同，只拷贝双方都有的部分
+    struct tcp_info info;
+    memset(&info, 0, sizeof(info));
+    memcpy(&info, RTA_DATA(attr),
+           std::min<size_t>(RTA_PAYLOAD(attr), sizeof(info)));
+    rtt_hist_[log2_bucket(info.tcpi_rtt)]++;
+    cwnd_hist_[log2_bucket(info.tcpi_snd_cwnd)]++;
+    if (info.tcpi_retransmits > 0) {
+      retransmitting_++;
+    }
+    unacked_ += info.tcpi_unacked;
+    break;
+  }
+}
+
+bool TcpSockMonitor::Dump(int family) {
+  struct {
+    struct nlmsghdr nlh;
+    struct inet_diag_req_v2 req;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.nlh.nlmsg_len = sizeof(request);
+  request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nlh.nlmsg_seq = ++seq_;
+  request.req.sdiag_family = family;
+  request.req.sdiag_protocol = IPPROTO_TCP;
+  request.req.idiag_states = ~0u;
+  request.req.idiag_ext = 1 << (INET_DIAG_INFO - 1);
+
+  struct sockaddr_nl addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+  if (sendto(fd_, &request, sizeof(request), 0,
+             reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+    std::cerr << "sock_diag sendto failed: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  while (true) {
+    ssize_t n = recv(fd_, buf_.data(), buf_.size(), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      std::cerr << "sock_diag recv failed: " << strerror(errno) << std::endl;
+      return false;
+    }
+    int remain = n;
+    for (auto *nlh = reinterpret_cast<struct nlmsghdr *>(buf_.data());
+         NLMSG_OK(nlh, remain); nlh = NLMSG_NEXT(nlh, remain)) {
+      if (nlh->nlmsg_seq != seq_) {
+        continue;
+      }
+      if (nlh->nlmsg_type == NLMSG_DONE) {
+        return true;
+      }
+      if (nlh->nlmsg_type == NLMSG_ERROR) {
+        auto *err = static_cast<struct nlmsgerr *>(NLMSG_DATA(nlh));
+        std::cerr << "sock_diag dump failed: " << strerror(-err->error)
+                  << std::endl;
+        return false;
+      }
+      Aggregate(static_cast<const struct inet_diag_msg *>(NLMSG_DATA(nlh)),
+                NLMSG_PAYLOAD(nlh, 0));
+    }
+  }
+}
+
+void TcpSockMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (fd_ < 0) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  memset(state_count_, 0, sizeof(state_count_));
+  memset(rtt_hist_, 0, sizeof(rtt_hist_));
+  memset(cwnd_hist_, 0, sizeof(cwnd_hist_));
+  retransmitting_ = 0;
+  unacked_ = 0;
+  send_queue_bytes_ = 0;
+  recv_queue_bytes_ = 0;
+  listen_.clear();
+  if (!Dump(AF_INET) || !Dump(AF_INET6)) {
+    return;
+  }
+
+  auto tcp_msg = monitor_info->mutable_tcp_sock_info();
+  uint32_t total = 0;
+  for (uint32_t count : state_count_) {
+    total += count;
+  }
+  tcp_msg->set_total(total);
+  tcp_msg->set_established(state_count_[kTcpEstablished]);
+  tcp_msg->set_syn_sent(state_count_[kTcpSynSent]);
+  tcp_msg->set_syn_recv(state_count_[kTcpSynRecv]);
+  tcp_msg->set_fin_wait1(state_count_[kTcpFinWait1]);
+  tcp_msg->set_fin_wait2(state_count_[kTcpFinWait2]);
+  tcp_msg->set_time_wait(state_count_[kTcpTimeWait]);
+  tcp_msg->set_close(state_count_[kTcpClose]);
+  tcp_msg->set_close_wait(state_count_[kTcpCloseWait]);
+  tcp_msg->set_last_ack(state_count_[kTcpLastAck]);
+  tcp_msg->set_listen(state_count_[kTcpListen]);
+  tcp_msg->set_closing(state_count_[kTcpClosing]);
+
+  std::vector<std::pair<float, uint16_t>> queues;
+  queues.reserve(listen_.size());
+  for (const auto &[port, lq] : listen_) {
+    float fill = lq.backlog > 0 ? lq.queue * 100.0 / lq.backlog : 0;
+    queues.emplace_back(fill, port);
+  }
+  size_t n = std::min(top_listen_, queues.size());
+  std::partial_sort(queues.begin(), queues.begin() + n, queues.end(),
+                    [](const auto &a, const auto &b) {
+                      return a.first > b.first;
+                    });
+  for (size_t i = 0; i < n; ++i) {
+    const ListenQueue &lq = listen_[queues[i].second];
+    auto queue_msg = tcp_msg->add_listen_queues();
+    queue_msg->set_port(queues[i].second);
+    queue_msg->set_sockets(lq.sockets);
+    queue_msg->set_queue(lq.queue);
+    queue_msg->set_backlog(lq.backlog);
+    queue_msg->set_fill_percent(queues[i].first);
+  }
+
+  tcp_msg->mutable_rtt_us_hist()->Add(rtt_hist_, rtt_hist_ + kHistBuckets);
+  tcp_msg->mutable_cwnd_hist()->Add(cwnd_hist_, cwnd_hist_ + kHistBuckets);
+  tcp_msg->set_rtt_us_p50(hist_percentile(rtt_hist_, 0.5));
+  tcp_msg->set_rtt_us_p99(hist_percentile(rtt_hist_, 0.99));
+  tcp_msg->set_cwnd_p50(hist_percentile(cwnd_hist_, 0.5));
+  tcp_msg->set_retransmitting(retransmitting_);
+  tcp_msg->set_unacked(unacked_);
+  tcp_msg->set_send_queue_bytes(send_queue_bytes_);
+  tcp_msg->set_recv_queue_bytes(recv_queue_bytes_);
+  tcp_msg->set_scan_cost_ms(std::chrono::duration<float, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+}
+
+void TcpSockMonitor::Stop() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+} // namespace yanhon
@@ -0,0 +1,215 @@
+#include "monitor/vmstat_monitor.hpp"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+namespace yanhon {
+struct VmStatKey {
+  const char *name;
+  VmStatField field;
+};
+
+static const VmStatKey kVmStatKeys[] = {
+    {"pgfault", kPgfault},
+    {"pgmajfault", kPgmajfault},
+    {"pgpgin", kPgpgin},
+    {"pgpgout", kPgpgout},
+    {"pswpin", kPswpin},
+    {"pswpout", kPswpout},
+    {"pgscan_kswapd", kPgscanKswapd},
+    {"pgscan_direct", kPgscanDirect},
+    {"pgsteal_kswapd", kPgstealKswapd},
+    {"pgsteal_direct", kPgstealDirect},
+    {"allocstall", kAllocstall}, // 4.x 内核
+    {"allocstall_dma", kAllocstall},
+    {"allocstall_dma32", kAllocstall},
+    {"allocstall_normal", kAllocstall},
+    {"allocstall_movable", kAllocstall},
+    {"allocstall_device", kAllocstall},
+    {"pgrefill", kPgrefill},
+    {"pgrotated", kPgrotated},
+    {"slabs_scanned", kSlabsScanned},
+    {"kswapd_inodesteal", kKswapdInodesteal},
+    {"pageoutrun", kPageoutrun},
+    {"workingset_refault_anon", kWorkingsetRefaultAnon},
+    {"workingset_refault_file", kWorkingsetRefaultFile},
+    {"workingset_refault", kWorkingsetRefaultFile}, // 5.9 之前不区分匿名页
+    {"workingset_activate_anon", kWorkingsetActivateAnon},
+    {"workingset_activate_file", kWorkingsetActivateFile},
+    {"workingset_activate", kWorkingsetActivateFile},
+    {"pgalloc_dma", kPgalloc},
+    {"pgalloc_dma32", kPgalloc},
+    {"pgalloc_normal", kPgalloc},
+    {"pgalloc_movable", kPgalloc},
+    {"pgalloc_device", kPgalloc},
+    {"pgfree", kPgfree},
+    {"pgactivate", kPgactivate},
+    {"pgdeactivate", kPgdeactivate},
+    {"compact_stall", kCompactStall},
+    {"compact_fail", kCompactFail},
+    {"compact_success", kCompactSuccess},
+    {"pgmigrate_success", kPgmigrateSuccess},
+    {"pgmigrate_fail", kPgmigrateFail},
+    {"thp_fault_alloc", kThpFaultAlloc},
+    {"thp_fault_fallback", kThpFaultFallback},
+    {"oom_kill", kOomKill},
+    {"nr_dirtied", kNrDirtied},
+    {"nr_written", kNrWritten},
+};
+
+static int16_t lookup_field(const char *key, size_t len) {
+  for (const auto &k : kVmStatKeys) {
+    if (strlen(k.name) == len && memcmp(k.name, key, len) == 0) {
+      return k.field;
+    }
+  }
+  return -1;
+}
+
+VmStatMonitor::VmStatMonitor() : buf_(16 * 1024) {
+  fd_ = open("/proc/vmstat", O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    std::cerr << "Failed to open /proc/vmstat: " << strerror(errno)
+              << std::endl;
+  }
+}
+
+VmStatMonitor::~VmStatMonitor() { Stop(); }
+
+/**
+ * @brief 首次读取（或行布局变化）时建立行号到字段的映射
+ */
+void VmStatMonitor::BuildIndex(const char *buf, const char *end) {
+  line_field_.clear();
+  line_key_len_.clear();
+  for (const char *p = buf; p < end;) {
+    const char *sp = static_cast<const char *>(memchr(p, ' ', end - p));
+    const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    if (!sp || !nl || sp > nl) {
+      break;
+    }
+    line_field_.push_back(lookup_field(p, sp - p));
+    line_key_len_.push_back(static_cast<uint16_t>(sp - p));
+    p = nl + 1;
+  }
+}
+
+bool VmStatMonitor::ReadCounters(uint64_t *values) {
+  ssize_t n;
+  while (true) {
+    n = pread(fd_, buf_.data(), buf_.size(), 0);
+    if (n <= 0) {
+      return false;
+    }
+    if (static_cast<size_t>(n) < buf_.size()) {
+      break;
+    }
+    // 缓冲区被读满，说明内容可能被截断
+    buf_.resize(buf_.size() * 2);
+  }
+  const char *end = buf_.data() + n;
+  if (line_field_.empty()) {
+    BuildIndex(buf_.data(), end);
+  }
+
+  memset(values, 0, sizeof(uint64_t) * kVmStatFieldCount);
+  size_t line = 0;
+  for (const char *p = buf_.data(); p < end; ++line) {
+    if (line >= line_field_.size()) {
+      // 行数变化（例如热插拔 zone），重建映射后下次生效
+      line_field_.clear();
+      break;
+    }
+    const char *v = p + line_key_len_[line];
+    if (v >= end || *v != ' ') {
+      line_field_.clear();
+      break;
+    }
+    int16_t field = line_field_[line];
+    ++v;
+    uint64_t value = 0;
+    while (*v >= '0' && *v <= '9') {
+      value = value * 10 + (*v - '0');
+      ++v;
+    }
+    if (field >= 0) {
+      values[field] += value;
+    }
+    const char *nl = static_cast<const char *>(memchr(v, '\n', end - v));
+    p = nl ? nl + 1 : end;
+  }
+  return !line_field_.empty();
+}
+
+void VmStatMonitor::UpdateOnce(monitor::proto::MonitorInfo *monitor_info) {
+  if (fd_ < 0) {
+    return;
+  }
+  uint64_t cur[kVmStatFieldCount];
+  if (!ReadCounters(cur) && !ReadCounters(cur)) {
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  double dt = std::chrono::duration<double>(now - last_time_).count();
+
+  if (has_last_ && dt > 0) {
+    double rate[kVmStatFieldCount];
+    for (int i = 0; i < kVmStatFieldCount; ++i) {
+      rate[i] = cur[i] >= last_[i] ? (cur[i] - last_[i]) / dt : 0;
+    }
+
+    auto vm_msg = monitor_info->mutable_vm_stat();
+    vm_msg->set_pgfault(rate[kPgfault]);
+    vm_msg->set_pgmajfault(rate[kPgmajfault]);
+    vm_msg->set_pgpgin(rate[kPgpgin]);
+    vm_msg->set_pgpgout(rate[kPgpgout]);
+    vm_msg->set_pswpin(rate[kPswpin]);
+    vm_msg->set_pswpout(rate[kPswpout]);
+    vm_msg->set_pgscan_kswapd(rate[kPgscanKswapd]);
+    vm_msg->set_pgscan_direct(rate[kPgscanDirect]);
+    vm_msg->set_pgsteal_kswapd(rate[kPgstealKswapd]);
+    vm_msg->set_pgsteal_direct(rate[kPgstealDirect]);
+    vm_msg->set_allocstall(rate[kAllocstall]);
+    vm_msg->set_pgrefill(rate[kPgrefill]);
+    vm_msg->set_pgrotated(rate[kPgrotated]);
+    vm_msg->set_slabs_scanned(rate[kSlabsScanned]);
+    vm_msg->set_kswapd_inodesteal(rate[kKswapdInodesteal]);
+    vm_msg->set_pageoutrun(rate[kPageoutrun]);
+    vm_msg->set_workingset_refault_anon(rate[kWorkingsetRefaultAnon]);
+    vm_msg->set_workingset_refault_file(rate[kWorkingsetRefaultFile]);
+    vm_msg->set_workingset_activate_anon(rate[kWorkingsetActivateAnon]);
+    vm_msg->set_workingset_activate_file(rate[kWorkingsetActivateFile]);
+    vm_msg->set_pgalloc(rate[kPgalloc]);
+    vm_msg->set_pgfree(rate[kPgfree]);
+    vm_msg->set_pgactivate(rate[kPgactivate]);
+    vm_msg->set_pgdeactivate(rate[kPgdeactivate]);
+    vm_msg->set_compact_stall(rate[kCompactStall]);
+    vm_msg->set_compact_fail(rate[kCompactFail]);
+    vm_msg->set_compact_success(rate[kCompactSuccess]);
+    vm_msg->set_pgmigrate_success(rate[kPgmigrateSuccess]);
+    vm_msg->set_pgmigrate_fail(rate[kPgmigrateFail]);
+    vm_msg->set_thp_fault_alloc(rate[kThpFaultAlloc]);
+    vm_msg->set_thp_fault_fallback(rate[kThpFaultFallback]);
+    vm_msg->set_oom_kill(rate[kOomKill]);
+    vm_msg->set_nr_dirtied(rate[kNrDirtied]);
+    vm_msg->set_nr_written(rate[kNrWritten]);
+
+    double scanned = rate[kPgscanKswapd] + rate[kPgscanDirect];
+    double stolen = rate[kPgstealKswapd] + rate[kPgstealDirect];
+    vm_msg->set_reclaim_efficiency(scanned > 0 ? stolen / scanned * 100.0
+                                               : 0);
+  }
+
+  memcpy(last_, cur, sizeof(last_));
+  last_time_ = now;
+  has_last_ = true;
+}
+
+void VmStatMonitor::Stop() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+} // namespace yanhon
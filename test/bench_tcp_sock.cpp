@@ -0,0 +1,180 @@
+// TcpSockMonitor 基准测试：在回环地址上建立 N 条 TCP 连接，对比
+// NETLINK_SOCK_DIAG 流式聚合与解析 /proc/net/tcp{,6} 的耗时
+//
+// 编译（在 build 目录生成 proto 之后）：
+//   g++ -O2 -std=c++20 test/bench_tcp_sock.cpp
+//       monitor/src/tcp_sock_monitor.cpp -Imonitor/include -Ibuild/proto
+//       build/proto/libmonitor_proto.a -lprotobuf -o bench_tcp_sock
+// 运行：./bench_tcp_sock [连接数，默认 100000]
+//
+// 每条连接占用两个 fd，单进程 fd 上限不够时分散到多个子进程中建立连接；
+// 每个子进程连向自己的监听端口，同一目的地址的连接数受本地端口范围
+// （net.ipv4.ip_local_port_range）限制，子进程的连接数也不超过该范围
+#include "monitor/tcp_sock_monitor.hpp"
+#include <arpa/inet.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+static int listen_loopback() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, 4096) < 0) {
+    perror("listen");
+    exit(1);
+  }
+  return fd;
+}
+
+// 子进程：建立 count 条连接后通知父进程并等待被杀死
+static void worker(int count, int notify_fd) {
+  int lfd = listen_loopback();
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (getsockname(lfd, (struct sockaddr *)&addr, &len) < 0) {
+    perror("getsockname");
+    exit(1);
+  }
+  int made = 0;
+  for (; made < count; ++made) {
+    int c = socket(AF_INET, SOCK_STREAM, 0);
+    if (c < 0 || connect(c, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+      perror("connect");
+      break;
+    }
+    if (accept(lfd, nullptr, nullptr) < 0) {
+      perror("accept");
+      break;
+    }
+  }
+  if (write(notify_fd, &made, sizeof(made)) != sizeof(made)) {
+    perror("write");
+  }
+  pause();
+  _exit(0);
+}
+
+// 本地端口范围内的端口数，读取失败时按内核默认的 32768-60999
+static int local_port_count() {
+  int lo = 32768, hi = 60999;
+  FILE *fp = fopen("/proc/sys/net/ipv4/ip_local_port_range", "r");
+  if (fp) {
+    if (fscanf(fp, "%d %d", &lo, &hi) != 2) {
+      lo = 32768;
+      hi = 60999;
+    }
+    fclose(fp);
+  }
+  return hi >= lo ? hi - lo + 1 : 1;
+}
+
+// 对照组：读取并解析 /proc/net/tcp 与 /proc/net/tcp6 的状态列
+static int parse_proc_net_tcp(int *state_count) {
+  int total = 0;
+  static char line[512];
+  for (const char *path : {"/proc/net/tcp", "/proc/net/tcp6"}) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+      continue;
+    }
+    fgets(line, sizeof(line), fp); // 表头
+    while (fgets(line, sizeof(line), fp)) {
+      unsigned state;
+      if (sscanf(line, "%*d: %*64[0-9A-Fa-f]:%*x %*64[0-9A-Fa-f]:%*x %x",
+                 &state) == 1) {
+        state_count[state & 15]++;
+        total++;
+      }
+    }
+    fclose(fp);
+  }
+  return total;
+}
+
+template <typename F> static double time_ms(int rounds, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    f();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         rounds;
+}
+
+int main(int argc, char **argv) {
+  int target = argc > 1 ? atoi(argv[1]) : 100000;
+  struct rlimit rl;
+  getrlimit(RLIMIT_NOFILE, &rl);
+  rl.rlim_cur = rl.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &rl);
+  int per_worker = std::min<rlim_t>((rl.rlim_cur - 64) / 2, INT_MAX);
+  per_worker = std::min(per_worker, local_port_count());
+
+  int pipefd[2];
+  if (pipe(pipefd) < 0) {
+    perror("pipe");
+    return 1;
+  }
+  std::vector<pid_t> children;
+  for (int left = target; left > 0; left -= per_worker) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(pipefd[0]);
+      worker(std::min(left, per_worker), pipefd[1]);
+    }
+    children.push_back(pid);
+  }
+  int established = 0;
+  for (size_t i = 0; i < children.size(); ++i) {
+    int made = 0;
+    if (read(pipefd[0], &made, sizeof(made)) != sizeof(made)) {
+      perror("read");
+      break;
+    }
+    established += made;
+  }
+  printf("connections: %d (%zu worker processes)\n", established,
+         children.size());
+
+  yanhon::TcpSockMonitor monitor;
+  monitor::proto::MonitorInfo info;
+  double diag_ms = time_ms(10, [&] {
+    info.Clear();
+    monitor.UpdateOnce(&info);
+  });
+  const auto &tcp = info.tcp_sock_info();
+  printf("sock_diag : %8.2f ms/scan  total=%u established=%u "
+         "rtt_p50=%uus cwnd_p50=%u\n",
+         diag_ms, tcp.total(), tcp.established(), tcp.rtt_us_p50(),
+         tcp.cwnd_p50());
+
+  int state_count[16];
+  int total = 0;
+  double proc_ms = time_ms(3, [&] {
+    memset(state_count, 0, sizeof(state_count));
+    total = parse_proc_net_tcp(state_count);
+  });
+  printf("/proc/net : %8.2f ms/scan  total=%d established=%d\n", proc_ms,
+         total, state_count[1]);
+
+  for (pid_t pid : children) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+// test_cpu_stat.c 与 test_softirq_monitor.c 共用：映射 /dev/cpu_monitor，
+// 按头部的分段表查找分段，并按 seq 协议复制一份完整的活动数据区
+#pragma once
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "cpu_monitor_shm.h"
+
+#ifndef DEVICE_PATH
+#define DEVICE_PATH "/dev/" CPU_MONITOR_DEVICE
+#endif
+
+struct cpu_monitor_map {
+  int fd;
+  void *base;
+  size_t size;
+  const struct cpu_monitor_header *hdr;
+};
+
+// 映射大小：两个数据区之后再加上共享分段中最靠后的一个
+static size_t cpu_monitor_map_size(const struct cpu_monitor_header *hdr) {
+  size_t size = hdr->header_size + 2 * hdr->area_size;
+  for (__u32 i = 0; i < hdr->nr_sections && i < CPU_MONITOR_MAX_SECTIONS;
+       i++) {
+    const struct cpu_monitor_section *sec = &hdr->sections[i];
+    size_t end = sec->offset + (size_t)sec->nr_rows * sec->row_size;
+    if ((sec->flags & CPU_MONITOR_SECTION_F_SHARED) && end > size) {
+      size = end;
+    }
+  }
+  return size;
+}
+
+static int cpu_monitor_map_open(struct cpu_monitor_map *map) {
+  long page = sysconf(_SC_PAGESIZE);
+  const struct cpu_monitor_header *hdr;
+  void *base;
+
+  map->fd = open(DEVICE_PATH, O_RDONLY | O_CLOEXEC);
+  if (map->fd < 0) {
+    perror("Failed to open " DEVICE_PATH);
+    return -1;
+  }
+  // 先只映射头部读出布局，再映射整个区域
+  base = mmap(NULL, page, PROT_READ, MAP_SHARED, map->fd, 0);
+  if (base == MAP_FAILED) {
+    perror("Failed to mmap device header");
+    close(map->fd);
+    return -1;
+  }
+  hdr = base;
+  if (hdr->magic != CPU_MONITOR_MAGIC || hdr->version != CPU_MONITOR_VERSION) {
+    fprintf(stderr, "Unexpected layout: magic %#x version %u\n", hdr->magic,
+            hdr->version);
+    munmap(base, page);
+    close(map->fd);
+    return -1;
+  }
+  map->size = cpu_monitor_map_size(hdr);
+  munmap(base, page);
+
+  map->base = mmap(NULL, map->size, PROT_READ, MAP_SHARED, map->fd, 0);
+  if (map->base == MAP_FAILED) {
+    perror("Failed to mmap device");
+    close(map->fd);
+    return -1;
+  }
+  map->hdr = map->base;
+  return 0;
+}
+
+static void cpu_monitor_map_close(struct cpu_monitor_map *map) {
+  munmap(map->base, map->size);
+  close(map->fd);
+}
+
+// 数据区内的分段，返回其在数据区中的偏移，不存在或行大小不符时返回 -1
+static long cpu_monitor_find(const struct cpu_monitor_map *map, __u32 id,
+                             size_t row_size, __u32 *nr_rows) {
+  const struct cpu_monitor_header *hdr = map->hdr;
+
+  for (__u32 i = 0; i < hdr->nr_sections && i < CPU_MONITOR_MAX_SECTIONS;
+       i++) {
+    const struct cpu_monitor_section *sec = &hdr->sections[i];
+    if (sec->id == id && !(sec->flags & CPU_MONITOR_SECTION_F_SHARED) &&
+        sec->row_size == row_size) {
+      *nr_rows = sec->nr_rows;
+      return (long)sec->offset;
+    }
+  }
+  return -1;
+}
+
+// 复制活动数据区到 area（area_size 字节），复制前后 seq 相同且为偶数时成功
+static int cpu_monitor_snapshot(const struct cpu_monitor_map *map,
+                                void *area) {
+  const struct cpu_monitor_header *hdr = map->hdr;
+
+  for (int retry = 0; retry < 100; retry++) {
+    __u32 seq = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      continue;
+    }
+    __u32 active = __atomic_load_n(&hdr->active, __ATOMIC_RELAXED) & 1;
+    memcpy(area,
+           (const char *)map->base + hdr->header_size +
+               active * hdr->area_size,
+           hdr->area_size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == seq) {
+      return 0;
+    }
+  }
+  fprintf(stderr, "Failed to read a consistent snapshot\n");
+  return -1;
+}
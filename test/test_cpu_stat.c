@@ -1,164 +1,119 @@
+// cpu_monitor 模块 STAT 分段的检查工具：打印各在线 CPU 的累计时间，
+// 3 秒后再读一次并输出期间的使用率
+//
+// 编译：gcc -O2 -Iinclude test/test_cpu_stat.c -o test_cpu_stat
+// 运行：./test_cpu_stat（需要先 sudo insmod kmod/cpu_monitor_kmod.ko）
 #include <errno.h>
-#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <time.h>
 #include <unistd.h>
 
-#define DEVICE_PATH "/dev/cpu_stat_monitor"
-#define MAX_CPU 128
+#include "cpu_monitor_map.h"
 
-// 与内核模块中相同的结构体定义
-struct cpu_stat {
-  char cpu_name[16];
-  unsigned long long user;
-  unsigned long long system;
-  unsigned long long idle;
-  unsigned long long nice;
-  unsigned long long io_wait;
-  unsigned long long irq;
-  unsigned long long soft_irq;
-  unsigned long long steal;
-  unsigned long long guest;
-  unsigned long long guest_nice;
-  unsigned long long total;
-  unsigned long long timestamp;
-};
-
-// 测试mmap功能
-void test_mmap_method(void) {
-  int fd;
-  struct cpu_stat *stats;
-  struct stat st;
-  int nr_cpus;
-  int i;
-
-  printf("=== Testing mmap method ===\n");
-
-  // 打开设备文件
-  fd = open(DEVICE_PATH, O_RDONLY);
-  if (fd < 0) {
-    perror("Failed to open device");
-    return;
-  }
-
-  // 获取设备文件状态
-  if (fstat(fd, &st) < 0) {
-    perror("Failed to stat device");
-    close(fd);
-    return;
-  }
-
-  // 映射内存
-  stats = (struct cpu_stat *)mmap(NULL, sizeof(struct cpu_stat) * MAX_CPU,
-                                  PROT_READ, MAP_SHARED, fd, 0);
-  if (stats == MAP_FAILED) {
-    perror("Failed to mmap device");
-    close(fd);
-    return;
-  }
-
-  // 获取CPU数量（实际在线的）
-  nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
-  printf("System has %d online CPUs\n", nr_cpus);
+static const struct cpu_monitor_stat *stat_rows(const char *area, long off) {
+  return (const struct cpu_monitor_stat *)(area + off);
+}
 
-  // 打印CPU统计信息
-  for (i = 0; i < nr_cpus && i < MAX_CPU; i++) {
-    struct cpu_stat *cpu = &stats[i];
+// 打印CPU统计信息
+static void print_stats(const struct cpu_monitor_stat *stats, __u32 nr_rows) {
+  for (__u32 i = 0; i < nr_rows; i++) {
+    const struct cpu_monitor_stat *cpu = &stats[i];
     unsigned long long used = cpu->user + cpu->nice + cpu->system;
     double usage = 0.0;
 
+    // 离线 CPU 的 cpu_name 为空
+    if (cpu->cpu_name[0] == '\0') {
+      continue;
+    }
     if (cpu->total > 0) {
       usage = (double)used * 100.0 / cpu->total;
     }
 
     printf("CPU %s:\n", cpu->cpu_name);
-    printf("  User:     %llu\n", cpu->user);
-    printf("  Nice:     %llu\n", cpu->nice);
-    printf("  System:   %llu\n", cpu->system);
-    printf("  Idle:     %llu\n", cpu->idle);
-    printf("  IOWait:   %llu\n", cpu->io_wait);
-    printf("  IRQ:      %llu\n", cpu->irq);
-    printf("  SoftIRQ:  %llu\n", cpu->soft_irq);
-    printf("  Total:    %llu\n", cpu->total);
-    printf("  Usage:    %.2f%%\n", usage);
+    printf("  User:     %llu ns\n", cpu->user);
+    printf("  Nice:     %llu ns\n", cpu->nice);
+    printf("  System:   %llu ns\n", cpu->system);
+    printf("  Idle:     %llu ns\n", cpu->idle);
+    printf("  IOWait:   %llu ns\n", cpu->io_wait);
+    printf("  IRQ:      %llu ns\n", cpu->irq);
+    printf("  SoftIRQ:  %llu ns\n", cpu->soft_irq);
+    printf("  Total:    %llu ns\n", cpu->total);
+    printf("  Usage:    %.2f%% (since boot)\n", usage);
     printf("  Timestamp:%llu\n", cpu->timestamp);
     printf("\n");
   }
+}
 
-  // 测试实时更新
-  printf("Testing real-time updates (waiting 3 seconds)...\n");
-  sleep(3);
-
-  printf("After 3 seconds:\n");
-  for (i = 0; i < nr_cpus && i < MAX_CPU; i++) {
-    struct cpu_stat *cpu = &stats[i];
-    printf("%s: Total=%llu, Timestamp=%llu\n", cpu->cpu_name, cpu->total,
-           cpu->timestamp);
+// 两次快照之间各 CPU 的使用率
+static void print_delta(const struct cpu_monitor_stat *prev,
+                        const struct cpu_monitor_stat *cur, __u32 nr_rows) {
+  for (__u32 i = 0; i < nr_rows; i++) {
+    if (cur[i].cpu_name[0] == '\0' || prev[i].cpu_name[0] == '\0' ||
+        cur[i].total <= prev[i].total) {
+      continue;
+    }
+    unsigned long long busy =
+        (cur[i].user + cur[i].nice + cur[i].system + cur[i].irq +
+         cur[i].soft_irq + cur[i].steal) -
+        (prev[i].user + prev[i].nice + prev[i].system + prev[i].irq +
+         prev[i].soft_irq + prev[i].steal);
+    printf("%s: Total=%llu, Timestamp=%llu, Usage=%.2f%%\n", cur[i].cpu_name,
+           cur[i].total, cur[i].timestamp,
+           busy * 100.0 / (cur[i].total - prev[i].total));
   }
-
-  // 取消映射
-  munmap(stats, sizeof(struct cpu_stat) * MAX_CPU);
-  close(fd);
 }
 
-// // 测试read功能
-// void test_read_method(void) {
-//   int fd;
-//   struct cpu_stat stats[MAX_CPU];
-//   ssize_t bytes_read;
-//   int nr_cpus;
-//   int i;
+int main(void) {
+  struct cpu_monitor_map map;
+  char *prev, *cur;
+  __u32 nr_rows;
+  long off;
 
-//   printf("\n=== Testing read method ===\n");
-
-//   fd = open(DEVICE_PATH, O_RDONLY);
-//   if (fd < 0) {
-//     perror("Failed to open device");
-//     return;
-//   }
-
-//   bytes_read = read(fd, stats, sizeof(stats));
-//   if (bytes_read < 0) {
-//     perror("Failed to read device");
-//     close(fd);
-//     return;
-//   }
-
-//   nr_cpus = bytes_read / sizeof(struct cpu_stat);
-//   printf("Read %ld bytes, %d CPU records\n", bytes_read, nr_cpus);
-
-//   for (i = 0; i < nr_cpus; i++) {
-//     struct cpu_stat *cpu = &stats[i];
-//     printf("CPU %d: user=%llu, system=%llu, idle=%llu\n", i, cpu->user,
-//            cpu->system, cpu->idle);
-//   }
-
-//   close(fd);
-// }
-
-int main(int argc, char *argv[]) {
   printf("CPU Stat Monitor Test Program\n");
   printf("==============================\n\n");
 
-  // 检查设备是否存在
-  if (access(DEVICE_PATH, F_OK) != 0) {
-    printf("Device %s not found. Make sure the kernel module is loaded.\n",
-           DEVICE_PATH);
-    printf("Try: sudo insmod cpu_stat_module.ko\n");
+  if (cpu_monitor_map_open(&map) != 0) {
+    printf("Make sure the kernel module is loaded.\n");
+    printf("Try: sudo insmod kmod/cpu_monitor_kmod.ko\n");
     return 1;
   }
+  off = cpu_monitor_find(&map, CPU_MONITOR_SECTION_STAT,
+                         sizeof(struct cpu_monitor_stat), &nr_rows);
+  if (off < 0) {
+    fprintf(stderr, "STAT section not found\n");
+    cpu_monitor_map_close(&map);
+    return 1;
+  }
+  printf("Mapped %zu bytes, nr_cpus=%u, interval=%llu ns\n", map.size,
+         map.hdr->nr_cpus, (unsigned long long)map.hdr->interval_ns);
+  printf("System has %ld online CPUs\n\n", sysconf(_SC_NPROCESSORS_ONLN));
+
+  prev = malloc(map.hdr->area_size);
+  cur = malloc(map.hdr->area_size);
+  if (!prev || !cur || cpu_monitor_snapshot(&map, prev) != 0) {
+    free(prev);
+    free(cur);
+    cpu_monitor_map_close(&map);
+    return 1;
+  }
+  print_stats(stat_rows(prev, off), nr_rows);
 
-  // 测试mmap方法
-  test_mmap_method();
-
-  // 测试read方法
-  test_read_method();
+  // 测试实时更新
+  printf("Testing real-time updates (waiting 3 seconds)...\n");
+  sleep(3);
+  if (cpu_monitor_snapshot(&map, cur) != 0) {
+    free(prev);
+    free(cur);
+    cpu_monitor_map_close(&map);
+    return 1;
+  }
+  printf("After 3 seconds:\n");
+  print_delta(stat_rows(prev, off), stat_rows(cur, off), nr_rows);
 
+  free(prev);
+  free(cur);
+  cpu_monitor_map_close(&map);
   printf("\n=== Test completed successfully ===\n");
   return 0;
-}
\ No newline at end of file
+}
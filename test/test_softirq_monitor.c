@@ -1,32 +1,18 @@
+// cpu_monitor 模块 SOFTIRQ 分段的检查工具：打印初始的累计次数，
+// 之后每 2 秒输出一次各 CPU 的增量
+//
+// 编译：gcc -O2 -Iinclude test/test_softirq_monitor.c -o test_softirq_monitor
+// 运行：./test_softirq_monitor（需要先 sudo insmod kmod/cpu_monitor_kmod.ko）
 #include <errno.h>
-#include <fcntl.h>
 #include <stdint.h> // 添加标准整数类型头文件
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/mman.h>
-#include <time.h>
 #include <unistd.h>
 
-#define MAX_CPU 128
-#define MAX_CPU_NAME 16
-
-// 必须与内核结构体完全一致
-struct softirq_stat {
-  char cpu_name[MAX_CPU_NAME];
-  uint32_t hi;
-  uint32_t timer;
-  uint32_t net_tx;
-  uint32_t net_rx;
-  uint32_t block;
-  uint32_t irq_poll;
-  uint32_t tasklet;
-  uint32_t sched;
-  uint32_t hrtimer;
-  uint32_t rcu;
-} __attribute__((packed));
-
-void print_header(void) {
+#include "cpu_monitor_map.h"
+
+static void print_header(void) {
   printf("%-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
          "CPU", "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", "IRQ_POLL",
          "TASKLET", "SCHED", "HRTIMER", "RCU");
@@ -34,125 +20,137 @@ void print_header(void) {
          "---------------------------------------------------\n");
 }
 
-void print_stats(struct softirq_stat *stats, const char *title) {
+static void print_stats(const struct cpu_monitor_softirq *stats,
+                        __u32 nr_rows, const char *title) {
   printf("\n=== %s ===\n", title);
   print_header();
 
-  for (int i = 0; i < MAX_CPU; i++) {
-    // 检查CPU名称是否有效
-    if (stats[i].cpu_name[0] == '\0' ||
-        strncmp(stats[i].cpu_name, "cpu", 3) != 0) {
+  for (__u32 i = 0; i < nr_rows; i++) {
+    // 离线 CPU 的 cpu_name 为空
+    if (stats[i].cpu_name[0] == '\0') {
       continue;
     }
 
-    printf("%-10s %-10u %-10u %-10u %-10u %-10u %-10u %-10u %-10u "
-           "%-10u %-10u\n",
-           stats[i].cpu_name, (uint32_t)stats[i].hi, (uint32_t)stats[i].timer,
-           (uint32_t)stats[i].net_tx, (uint32_t)stats[i].net_rx,
-           (uint32_t)stats[i].block, (uint32_t)stats[i].irq_poll,
-           (uint32_t)stats[i].tasklet, (uint32_t)stats[i].sched,
-           (uint32_t)stats[i].hrtimer, (uint32_t)stats[i].rcu);
+    printf("%-10s %-10llu %-10llu %-10llu %-10llu %-10llu %-10llu %-10llu "
+           "%-10llu %-10llu %-10llu\n",
+           stats[i].cpu_name, (unsigned long long)stats[i].hi,
+           (unsigned long long)stats[i].timer,
+           (unsigned long long)stats[i].net_tx,
+           (unsigned long long)stats[i].net_rx,
+           (unsigned long long)stats[i].block,
+           (unsigned long long)stats[i].irq_poll,
+           (unsigned long long)stats[i].tasklet,
+           (unsigned long long)stats[i].sched,
+           (unsigned long long)stats[i].hrtimer,
+           (unsigned long long)stats[i].rcu);
   }
 }
 
-void calculate_delta(struct softirq_stat *prev, struct softirq_stat *curr,
-                     struct softirq_stat *delta, int cpu) {
-  strncpy(delta[cpu].cpu_name, curr[cpu].cpu_name, MAX_CPU_NAME);
-  delta[cpu].hi = curr[cpu].hi - prev[cpu].hi;
-  delta[cpu].timer = curr[cpu].timer - prev[cpu].timer;
-  delta[cpu].net_tx = curr[cpu].net_tx - prev[cpu].net_tx;
-  delta[cpu].net_rx = curr[cpu].net_rx - prev[cpu].net_rx;
-  delta[cpu].block = curr[cpu].block - prev[cpu].block;
-  delta[cpu].irq_poll = curr[cpu].irq_poll - prev[cpu].irq_poll;
-  delta[cpu].tasklet = curr[cpu].tasklet - prev[cpu].tasklet;
-  delta[cpu].sched = curr[cpu].sched - prev[cpu].sched;
-  delta[cpu].hrtimer = curr[cpu].hrtimer - prev[cpu].hrtimer;
-  delta[cpu].rcu = curr[cpu].rcu - prev[cpu].rcu;
+// 计数为 64 位且只增不减；CPU 离线期间行被清空，两端都在线时才计算
+static void calculate_delta(const struct cpu_monitor_softirq *prev,
+                            const struct cpu_monitor_softirq *curr,
+                            struct cpu_monitor_softirq *delta) {
+  if (curr->cpu_name[0] == '\0' || prev->cpu_name[0] == '\0') {
+    return;
+  }
+  memcpy(delta->cpu_name, curr->cpu_name, sizeof(delta->cpu_name));
+  delta->hi = curr->hi - prev->hi;
+  delta->timer = curr->timer - prev->timer;
+  delta->net_tx = curr->net_tx - prev->net_tx;
+  delta->net_rx = curr->net_rx - prev->net_rx;
+  delta->block = curr->block - prev->block;
+  delta->irq_poll = curr->irq_poll - prev->irq_poll;
+  delta->tasklet = curr->tasklet - prev->tasklet;
+  delta->sched = curr->sched - prev->sched;
+  delta->hrtimer = curr->hrtimer - prev->hrtimer;
+  delta->rcu = curr->rcu - prev->rcu;
 }
 
-int main(int argc, char *argv[]) {
-  int fd;
-  struct softirq_stat *mapped_stats;
-  struct softirq_stat *prev_stats;
+int main(void) {
+  struct cpu_monitor_map map;
+  char *prev_area, *cur_area;
+  struct cpu_monitor_softirq *delta;
   int iterations = 10;
   int interval = 2;
-  size_t buffer_size;
+  __u32 nr_rows;
+  long off;
+  int ret = 1;
 
   printf("CPU SoftIRQ Monitor Test Program\n");
   printf("================================\n\n");
 
-  // 打开设备文件
-  fd = open("/dev/cpu_softirq_monitor", O_RDONLY);
-  if (fd < 0) {
-    perror("Failed to open /dev/cpu_softirq_monitor");
-    printf("Try: sudo insmod cpu_softirq_monitor.ko\n");
+  if (cpu_monitor_map_open(&map) != 0) {
+    printf("Try: sudo insmod kmod/cpu_monitor_kmod.ko\n");
     return 1;
   }
-
-  buffer_size = sizeof(struct softirq_stat) * MAX_CPU;
-  printf("Struct size: %lu bytes\n", sizeof(struct softirq_stat));
-  printf("Total buffer size: %lu bytes\n", buffer_size);
-
-  // 映射内存
-  mapped_stats = mmap(NULL, buffer_size, PROT_READ, MAP_SHARED, fd, 0);
-  if (mapped_stats == MAP_FAILED) {
-    perror("mmap failed");
-    close(fd);
+  off = cpu_monitor_find(&map, CPU_MONITOR_SECTION_SOFTIRQ,
+                         sizeof(struct cpu_monitor_softirq), &nr_rows);
+  if (off < 0) {
+    fprintf(stderr, "SOFTIRQ section not found\n");
+    cpu_monitor_map_close(&map);
     return 1;
   }
-
-  printf("Memory mapped successfully at %p\n\n", mapped_stats);
-
-  // 分配空间存储前一次的快照
-  prev_stats = malloc(buffer_size);
-  if (!prev_stats) {
+  printf("Row size: %zu bytes, %u rows\n", sizeof(struct cpu_monitor_softirq),
+         nr_rows);
+  printf("Memory mapped successfully at %p, %zu bytes\n", map.base, map.size);
+
+  // 分配空间存储前后两次的快照
+  prev_area = malloc(map.hdr->area_size);
+  cur_area = malloc(map.hdr->area_size);
+  delta = calloc(nr_rows, sizeof(*delta));
+  if (!prev_area || !cur_area || !delta) {
     perror("malloc failed");
-    munmap(mapped_stats, buffer_size);
-    close(fd);
-    return 1;
+    goto out;
   }
 
   // 初始快照
-  memcpy(prev_stats, mapped_stats, buffer_size);
-  print_stats(prev_stats, "Initial State");
+  if (cpu_monitor_snapshot(&map, prev_area) != 0) {
+    goto out;
+  }
+  const struct cpu_monitor_softirq *prev =
+      (const struct cpu_monitor_softirq *)(prev_area + off);
+  const struct cpu_monitor_softirq *cur =
+      (const struct cpu_monitor_softirq *)(cur_area + off);
+  print_stats(prev, nr_rows, "Initial State");
 
   for (int i = 0; i < iterations; i++) {
     sleep(interval);
+    if (cpu_monitor_snapshot(&map, cur_area) != 0) {
+      goto out;
+    }
 
     // 计算增量
-    struct softirq_stat delta[MAX_CPU];
-    memset(delta, 0, buffer_size);
-
-    for (int j = 0; j < MAX_CPU; j++) {
-      if (mapped_stats[j].cpu_name[0] == '\0')
-        continue;
-      calculate_delta(prev_stats, mapped_stats, delta, j);
+    memset(delta, 0, nr_rows * sizeof(*delta));
+    for (__u32 j = 0; j < nr_rows; j++) {
+      calculate_delta(&prev[j], &cur[j], &delta[j]);
     }
 
     char title[64];
     snprintf(title, sizeof(title),
              "Incremental Stats (Last %d seconds) - Iteration %d", interval,
              i + 1);
-    print_stats(delta, title);
-
-    // 保存当前快照
-    memcpy(prev_stats, mapped_stats, buffer_size);
+    print_stats(delta, nr_rows, title);
 
     // 验证数据
-    printf("\nData validation for cpu0:\n");
-    if (mapped_stats[0].cpu_name[0] != '\0') {
-      printf("  cpu_name: %s\n", mapped_stats[0].cpu_name);
-      printf("  timer: %lu (prev: %lu, delta: %lu)\n",
-             (unsigned long)mapped_stats[0].timer,
-             (unsigned long)prev_stats[0].timer, (unsigned long)delta[0].timer);
+    printf("\nData validation for %s:\n",
+           cur[0].cpu_name[0] ? cur[0].cpu_name : "cpu0 (offline)");
+    if (cur[0].cpu_name[0] != '\0') {
+      printf("  timer: %llu (prev: %llu, delta: %llu)\n",
+             (unsigned long long)cur[0].timer,
+             (unsigned long long)prev[0].timer,
+             (unsigned long long)delta[0].timer);
     }
-  }
 
-  // 清理
-  free(prev_stats);
-  munmap(mapped_stats, buffer_size);
-  close(fd);
+    // 保存当前快照
+    memcpy(prev_area, cur_area, map.hdr->area_size);
+  }
 
   printf("\nTest completed successfully\n");
-  return 0;
-}
\ No newline at end of file
+  ret = 0;
+out:
+  free(delta);
+  free(prev_area);
+  free(cur_area);
+  cpu_monitor_map_close(&map);
+  return ret;
+}